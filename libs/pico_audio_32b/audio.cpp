@@ -30,6 +30,9 @@
 #include <cstring>              // For memory operations
 #include "pico/audio.h"         // Audio framework definitions
 #include "pico/sample_conversion.h"  // Sample format conversion utilities
+#include "pico/audio_trace.h"   // Event tracing (compiled out unless PICO_AUDIO_TRACE)
+#include "pico/audio_latency.h" // Latency probe hooks (compiled out unless PICO_AUDIO_LATENCY)
+#include "pico/time.h"          // Stream API timeouts
 
 // ============================================================================
 // Debug Configuration
@@ -168,6 +171,52 @@ inline static void list_append_with_tail(audio_buffer_t **phead, audio_buffer_t
     }
 }
 
+/**
+ * @brief Queue a full buffer on the calling core's prepared ring
+ *
+ * Only the calling core writes its ring's tail, so no lock is needed; the
+ * release fence publishes the slot before the new tail.
+ *
+ * @param context Multi-producer pool
+ * @param ab      Buffer to queue
+ */
+inline static void ring_append(audio_buffer_pool_t *context, audio_buffer_t *ab)
+{
+    audio_prepared_ring_t *ring = &context->prepared_rings[get_core_num()];
+    uint32_t tail = ring->tail;
+    // a ring has room for every buffer in the pool, so it can never be full
+    audio_assert(tail - ring->head <= context->prepared_ring_mask);
+    ring->slots[tail & context->prepared_ring_mask] = ab;
+    __mem_fence_release();
+    ring->tail = tail + 1;
+}
+
+/**
+ * @brief Take the next full buffer from the prepared rings (single consumer)
+ *
+ * Rings are visited round robin starting after the last one served, so one
+ * busy producer cannot starve the other.
+ *
+ * @param context Multi-producer pool
+ * @return Buffer, or NULL if all rings are empty
+ */
+inline static audio_buffer_t *ring_remove_head(audio_buffer_pool_t *context)
+{
+    for (uint i = 0; i < NUM_CORES; i++) {
+        uint index = (context->prepared_ring_next + i) % NUM_CORES;
+        audio_prepared_ring_t *ring = &context->prepared_rings[index];
+        uint32_t head = ring->head;
+        if (head == ring->tail) continue;
+        __mem_fence_acquire();
+        audio_buffer_t *ab = ring->slots[head & context->prepared_ring_mask];
+        __mem_fence_release();
+        ring->head = head + 1;
+        context->prepared_ring_next = (uint8_t) ((index + 1) % NUM_CORES);
+        return ab;
+    }
+    return NULL;
+}
+
 audio_buffer_t *get_free_audio_buffer(audio_buffer_pool_t *context, bool block) {
     audio_buffer_t *ab;
 
@@ -196,6 +245,8 @@ audio_buffer_t *get_free_audio_buffer(audio_buffer_pool_t *context, bool block)
 void queue_free_audio_buffer(audio_buffer_pool_t *context, audio_buffer_t *ab) 
 {
     assert(!ab->next);  // Buffer must not be in a list
+    ab->segments = NULL;  // forget any fragments the producer pointed it at
+    ab->segment_count = 0;
     
     // Atomically add buffer back to free list
     uint32_t save = spin_lock_blocking(context->free_list_spin_lock);
@@ -225,10 +276,14 @@ audio_buffer_t *get_full_audio_buffer(audio_buffer_pool_t *context, bool block)
     audio_buffer_t *ab;
     
     do {
-        // Atomically remove a buffer from the prepared list
-        uint32_t save = spin_lock_blocking(context->prepared_list_spin_lock);
-        ab = list_remove_head_with_tail(&context->prepared_list, &context->prepared_list_tail);
-        spin_unlock(context->prepared_list_spin_lock, save);
+        if (context->prepared_rings) {
+            ab = ring_remove_head(context);
+        } else {
+            // Atomically remove a buffer from the prepared list
+            uint32_t save = spin_lock_blocking(context->prepared_list_spin_lock);
+            ab = list_remove_head_with_tail(&context->prepared_list, &context->prepared_list_tail);
+            spin_unlock(context->prepared_list_spin_lock, save);
+        }
         
         // Return buffer if found, or if non-blocking mode
         if (ab || !block) break;
@@ -242,9 +297,13 @@ audio_buffer_t *get_full_audio_buffer(audio_buffer_pool_t *context, bool block)
 
 void queue_full_audio_buffer(audio_buffer_pool_t *context, audio_buffer_t *ab) {
     assert(!ab->next);
-    uint32_t save = spin_lock_blocking(context->prepared_list_spin_lock);
-    list_append_with_tail(&context->prepared_list, &context->prepared_list_tail, ab);
-    spin_unlock(context->prepared_list_spin_lock, save);
+    if (context->prepared_rings) {
+        ring_append(context, ab);
+    } else {
+        uint32_t save = spin_lock_blocking(context->prepared_list_spin_lock);
+        list_append_with_tail(&context->prepared_list, &context->prepared_list_tail, ab);
+        spin_unlock(context->prepared_list_spin_lock, save);
+    }
     __sev();
 }
 
@@ -284,16 +343,15 @@ void audio_init_buffer(audio_buffer_t *audio_buffer, audio_buffer_format_t *form
     audio_buffer->buffer = pico_buffer_alloc(buffer_sample_count * format->sample_stride);
     audio_buffer->max_sample_count = buffer_sample_count;
     audio_buffer->sample_count = 0;
+    audio_buffer->segments = NULL;
+    audio_buffer->segment_count = 0;
 }
 
-audio_buffer_pool_t *
-audio_new_buffer_pool(audio_buffer_format_t *format, int buffer_count, int buffer_sample_count) {
-    audio_buffer_pool_t *ac = (audio_buffer_pool_t *) calloc(1, sizeof(audio_buffer_pool_t));
-    audio_buffer_t *audio_buffers = buffer_count ? (audio_buffer_t *) calloc(buffer_count,
-                                                                                       sizeof(audio_buffer_t)) : 0;
+// link already initialised buffers into a pool's free list
+static void audio_init_pool_lists(audio_buffer_pool_t *ac, audio_buffer_format_t *format, audio_buffer_t *audio_buffers,
+                                  int buffer_count) {
     ac->format = format->format;
     for (int i = 0; i < buffer_count; i++) {
-        audio_init_buffer(audio_buffers + i, format, buffer_sample_count);
         audio_buffers[i].next = i != buffer_count - 1 ? &audio_buffers[i + 1] : NULL;
     }
     // todo one per channel?
@@ -303,9 +361,40 @@ audio_new_buffer_pool(audio_buffer_format_t *format, int buffer_count, int buffe
     ac->prepared_list = NULL;
     ac->prepared_list_tail = NULL;
     ac->connection = &connection_default;
+}
+
+audio_buffer_pool_t *
+audio_new_buffer_pool(audio_buffer_format_t *format, int buffer_count, int buffer_sample_count) {
+    audio_buffer_pool_t *ac = (audio_buffer_pool_t *) calloc(1, sizeof(audio_buffer_pool_t));
+    audio_buffer_t *audio_buffers = buffer_count ? (audio_buffer_t *) calloc(buffer_count,
+                                                                                       sizeof(audio_buffer_t)) : 0;
+    for (int i = 0; i < buffer_count; i++) {
+        audio_init_buffer(audio_buffers + i, format, buffer_sample_count);
+    }
+    audio_init_pool_lists(ac, format, audio_buffers, buffer_count);
     return ac;
 }
 
+void audio_init_static_pool(audio_buffer_pool_t *pool, bool consumer, audio_buffer_format_t *format,
+                            audio_buffer_t *buffers, mem_buffer_t *mem_buffers, uint8_t *storage,
+                            int buffer_count, int buffer_sample_count) {
+    memset(pool, 0, sizeof(audio_buffer_pool_t));
+    size_t buffer_bytes = (size_t) buffer_sample_count * format->sample_stride;
+    for (int i = 0; i < buffer_count; i++) {
+        mem_buffers[i].bytes = storage + i * buffer_bytes;
+        mem_buffers[i].size = buffer_bytes;
+        mem_buffers[i].flags = 0;
+        buffers[i].format = format;
+        buffers[i].buffer = &mem_buffers[i];
+        buffers[i].max_sample_count = buffer_sample_count;
+        buffers[i].sample_count = 0;
+        buffers[i].segments = NULL;
+        buffers[i].segment_count = 0;
+    }
+    audio_init_pool_lists(pool, format, buffers, buffer_count);
+    pool->type = consumer ? audio_buffer_pool::ac_consumer : audio_buffer_pool::ac_producer;
+}
+
 audio_buffer_t *audio_new_wrapping_buffer(audio_buffer_format_t *format, mem_buffer_t *buffer) {
     audio_buffer_t *audio_buffer = (audio_buffer_t *) calloc(1, sizeof(audio_buffer_t));
     if (audio_buffer) {
@@ -326,6 +415,19 @@ audio_new_producer_pool(audio_buffer_format_t *format, int buffer_count, int buf
     return ac;
 }
 
+audio_buffer_pool_t *
+audio_new_mpsc_producer_pool(audio_buffer_format_t *format, int buffer_count, int buffer_sample_count) {
+    audio_buffer_pool_t *ac = audio_new_producer_pool(format, buffer_count, buffer_sample_count);
+    uint32_t capacity = 1;
+    while (capacity < (uint32_t) buffer_count) capacity <<= 1;
+    ac->prepared_rings = (audio_prepared_ring_t *) calloc(NUM_CORES, sizeof(audio_prepared_ring_t));
+    for (uint i = 0; i < NUM_CORES; i++) {
+        ac->prepared_rings[i].slots = (audio_buffer_t **) calloc(capacity, sizeof(audio_buffer_t *));
+    }
+    ac->prepared_ring_mask = capacity - 1;
+    return ac;
+}
+
 audio_buffer_pool_t *
 audio_new_consumer_pool(audio_buffer_format_t *format, int buffer_count, int buffer_sample_count) {
     audio_buffer_pool_t *ac = audio_new_buffer_pool(format, buffer_count, buffer_sample_count);
@@ -346,18 +448,28 @@ void audio_complete_connection(audio_connection_t *connection, audio_buffer_pool
 void give_audio_buffer(audio_buffer_pool_t *ac, audio_buffer_t *buffer) {
     buffer->user_data = 0;
     assert(ac->connection);
-    if (ac->type == audio_buffer_pool::ac_producer)
+    audio_trace(AUDIO_TRACE_BUFFER_GIVE, ac->type);
+    if (ac->type == audio_buffer_pool::ac_producer) {
+#if PICO_AUDIO_LATENCY
+        if (audio_latency_state) audio_latency_on_give(buffer);
+#endif
         ac->connection->producer_pool_give(ac->connection, buffer);
-    else
+    } else
         ac->connection->consumer_pool_give(ac->connection, buffer);
 }
 
 audio_buffer_t *take_audio_buffer(audio_buffer_pool_t *ac, bool block) {
     assert(ac->connection);
-    if (ac->type == audio_buffer_pool::ac_producer)
-        return ac->connection->producer_pool_take(ac->connection, block);
-    else
-        return ac->connection->consumer_pool_take(ac->connection, block);
+    audio_buffer_t *buffer;
+    if (ac->type == audio_buffer_pool::ac_producer) {
+        buffer = ac->connection->producer_pool_take(ac->connection, block);
+#if PICO_AUDIO_LATENCY
+        if (buffer && audio_latency_state) audio_latency_on_take(buffer);
+#endif
+    } else
+        buffer = ac->connection->consumer_pool_take(ac->connection, block);
+    if (buffer) audio_trace(AUDIO_TRACE_BUFFER_TAKE, ac->type);
+    return buffer;
 }
 
 // todo rename this - this is s16 to s16
@@ -393,4 +505,185 @@ void stereo_s16_to_stereo_s16_producer_give(audio_connection_t *connection, audi
 
 void stereo_s32_to_stereo_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
     return producer_pool_blocking_give<Stereo<FmtS32>, Stereo<FmtS32>>(connection, buffer);
-}
\ No newline at end of file
+}
+
+audio_buffer_t *stereo_f32_to_stereo_s32_consumer_take(audio_connection_t *connection, bool block) {
+    return consumer_pool_take<Stereo<FmtS32>, Stereo<FmtF32>>(connection, block);
+}
+
+audio_buffer_t *stereo_f32_to_stereo_s16_consumer_take(audio_connection_t *connection, bool block) {
+    return consumer_pool_take<Stereo<FmtS16>, Stereo<FmtF32>>(connection, block);
+}
+
+void stereo_f32_to_stereo_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    return producer_pool_blocking_give<Stereo<FmtS32>, Stereo<FmtF32>>(connection, buffer);
+}
+
+void stereo_f32_to_stereo_s16_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    return producer_pool_blocking_give<Stereo<FmtS16>, Stereo<FmtF32>>(connection, buffer);
+}
+
+audio_buffer_t *i2s_lines2_s16_consumer_take(audio_connection_t *connection, bool block) {
+    return consumer_pool_take<I2SLinesFmt<FmtS16, 2>, MultiChannelFmt<FmtS16, 4>>(connection, block);
+}
+
+audio_buffer_t *i2s_lines4_s16_consumer_take(audio_connection_t *connection, bool block) {
+    return consumer_pool_take<I2SLinesFmt<FmtS16, 4>, MultiChannelFmt<FmtS16, 8>>(connection, block);
+}
+
+audio_buffer_t *i2s_lines2_s32_consumer_take(audio_connection_t *connection, bool block) {
+    return consumer_pool_take<I2SLinesFmt<FmtS32, 2>, MultiChannelFmt<FmtS32, 4>>(connection, block);
+}
+
+audio_buffer_t *i2s_lines4_s32_consumer_take(audio_connection_t *connection, bool block) {
+    return consumer_pool_take<I2SLinesFmt<FmtS32, 4>, MultiChannelFmt<FmtS32, 8>>(connection, block);
+}
+
+void i2s_lines2_s16_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    return producer_pool_blocking_give<I2SLinesFmt<FmtS16, 2>, MultiChannelFmt<FmtS16, 4>>(connection, buffer);
+}
+
+void i2s_lines4_s16_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    return producer_pool_blocking_give<I2SLinesFmt<FmtS16, 4>, MultiChannelFmt<FmtS16, 8>>(connection, buffer);
+}
+
+void i2s_lines2_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    return producer_pool_blocking_give<I2SLinesFmt<FmtS32, 2>, MultiChannelFmt<FmtS32, 4>>(connection, buffer);
+}
+
+void i2s_lines4_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    return producer_pool_blocking_give<I2SLinesFmt<FmtS32, 4>, MultiChannelFmt<FmtS32, 8>>(connection, buffer);
+}
+
+/**
+ * @brief Take a buffer for the stream API, waiting up to a deadline
+ *
+ * @param pool       Pool to take from
+ * @param timeout_us 0 for no wait, AUDIO_STREAM_WAIT_FOREVER to block
+ * @param until      Deadline for any other timeout
+ * @return Buffer, or NULL on timeout
+ */
+static audio_buffer_t *stream_take(audio_buffer_pool_t *pool, uint32_t timeout_us, absolute_time_t until) {
+    if (timeout_us == AUDIO_STREAM_WAIT_FOREVER) return take_audio_buffer(pool, true);
+    do {
+        audio_buffer_t *ab = take_audio_buffer(pool, false);
+        if (ab || !timeout_us) return ab;
+    } while (!best_effort_wfe_or_timeout(until));
+    return take_audio_buffer(pool, false);
+}
+
+uint audio_stream_write(audio_buffer_pool_t *pool, const void *frames, uint frame_count, uint32_t timeout_us) {
+    assert(pool->type == audio_buffer_pool::ac_producer);
+    absolute_time_t until = make_timeout_time_us(timeout_us);
+    const uint8_t *src = (const uint8_t *) frames;
+    uint written = 0;
+    while (written < frame_count) {
+        audio_buffer_t *ab = pool->stream_buffer;
+        if (!ab) {
+            ab = stream_take(pool, timeout_us, until);
+            if (!ab) break;
+            ab->sample_count = 0;
+            pool->stream_buffer = ab;
+        }
+        uint stride = ab->format->sample_stride;
+        uint count = std::min(frame_count - written, ab->max_sample_count - ab->sample_count);
+        memcpy(ab->buffer->bytes + ab->sample_count * stride, src, count * stride);
+        src += count * stride;
+        written += count;
+        ab->sample_count += count;
+        if (ab->sample_count == ab->max_sample_count) {
+            pool->stream_buffer = NULL;
+            give_audio_buffer(pool, ab);
+        }
+    }
+    return written;
+}
+
+void audio_stream_flush(audio_buffer_pool_t *pool) {
+    audio_buffer_t *ab = pool->stream_buffer;
+    if (ab) {
+        pool->stream_buffer = NULL;
+        give_audio_buffer(pool, ab);
+    }
+}
+
+uint audio_stream_read(audio_buffer_pool_t *pool, void *frames, uint frame_count, uint32_t timeout_us) {
+    assert(pool->type == audio_buffer_pool::ac_consumer);
+    absolute_time_t until = make_timeout_time_us(timeout_us);
+    uint8_t *dest = (uint8_t *) frames;
+    uint read = 0;
+    while (read < frame_count) {
+        audio_buffer_t *ab = pool->stream_buffer;
+        if (!ab) {
+            ab = stream_take(pool, timeout_us, until);
+            if (!ab) break;
+            ab->user_data = 0; // frames already read
+            pool->stream_buffer = ab;
+        }
+        uint stride = ab->format->sample_stride;
+        uint count = std::min(frame_count - read, (uint) (ab->sample_count - ab->user_data));
+        memcpy(dest, ab->buffer->bytes + ab->user_data * stride, count * stride);
+        dest += count * stride;
+        read += count;
+        ab->user_data += count;
+        if (ab->user_data == ab->sample_count) {
+            pool->stream_buffer = NULL;
+            give_audio_buffer(pool, ab);
+        }
+    }
+    return read;
+}
+
+audio_buffer_t *passthru_consumer_take(audio_connection_t *connection, bool block) {
+    return get_full_audio_buffer(connection->producer_pool, block);
+}
+
+void passthru_consumer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    queue_free_audio_buffer(connection->producer_pool, buffer);
+}
+
+// unrolled by 4 so the FPU conversions issue back to back
+void __time_critical_func(audio_convert_f32_to_s32)(int32_t *dest, const float *src, uint sample_count) {
+    for (; sample_count >= 4; sample_count -= 4) {
+        int32_t a = audio_f32_to_s32(src[0]);
+        int32_t b = audio_f32_to_s32(src[1]);
+        int32_t c = audio_f32_to_s32(src[2]);
+        int32_t d = audio_f32_to_s32(src[3]);
+        dest[0] = a; dest[1] = b; dest[2] = c; dest[3] = d;
+        src += 4;
+        dest += 4;
+    }
+    for (; sample_count; sample_count--) {
+        *dest++ = audio_f32_to_s32(*src++);
+    }
+}
+
+void __time_critical_func(audio_convert_f32_to_s24)(int32_t *dest, const float *src, uint sample_count) {
+    for (; sample_count >= 4; sample_count -= 4) {
+        int32_t a = audio_f32_to_s24(src[0]);
+        int32_t b = audio_f32_to_s24(src[1]);
+        int32_t c = audio_f32_to_s24(src[2]);
+        int32_t d = audio_f32_to_s24(src[3]);
+        dest[0] = a; dest[1] = b; dest[2] = c; dest[3] = d;
+        src += 4;
+        dest += 4;
+    }
+    for (; sample_count; sample_count--) {
+        *dest++ = audio_f32_to_s24(*src++);
+    }
+}
+
+void __time_critical_func(audio_convert_f32_to_s16)(int16_t *dest, const float *src, uint sample_count) {
+    for (; sample_count >= 4; sample_count -= 4) {
+        int16_t a = audio_f32_to_s16(src[0]);
+        int16_t b = audio_f32_to_s16(src[1]);
+        int16_t c = audio_f32_to_s16(src[2]);
+        int16_t d = audio_f32_to_s16(src[3]);
+        dest[0] = a; dest[1] = b; dest[2] = c; dest[3] = d;
+        src += 4;
+        dest += 4;
+    }
+    for (; sample_count; sample_count--) {
+        *dest++ = audio_f32_to_s16(*src++);
+    }
+}
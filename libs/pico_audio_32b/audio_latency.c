@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file audio_latency.c
+ * @brief Producer to pin latency probe
+ *
+ * The probe is a small state machine; each state has exactly one writer
+ * (thread for ARMED, producer for TAKEN/STAMPED, output IRQ for QUEUED/IDLE),
+ * so a release fence on every transition is enough to hand it between cores.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/audio_latency.h"
+#include "hardware/timer.h"
+
+// a marker not seen within this time is counted as lost and the probe re-armed
+#define AUDIO_LATENCY_LOST_TIMEOUT_US 1000000u
+
+volatile uint8_t audio_latency_state;
+
+static struct {
+    uint32_t remaining;             // probes still to run after the current one
+    uint32_t take_us;               // time_us_32() at take_audio_buffer()
+    const audio_buffer_t *buffer;   // buffer carrying the marker
+    uint32_t pin_offset_us;         // marker position within the queued transfer
+    audio_latency_stats_t stats;
+} probe;
+
+static void set_state(uint8_t state) {
+    __mem_fence_release();
+    audio_latency_state = state;
+}
+
+static void next_probe(void) {
+    if (probe.remaining) {
+        probe.remaining--;
+        set_state(AUDIO_LATENCY_ARMED);
+    } else {
+        set_state(AUDIO_LATENCY_IDLE);
+    }
+}
+
+void audio_latency_probe_start(uint32_t count) {
+    if (!count) return;
+    uint32_t save = save_and_disable_interrupts();
+    probe.remaining += count;
+    if (audio_latency_state == AUDIO_LATENCY_IDLE) next_probe();
+    restore_interrupts(save);
+}
+
+void audio_latency_reset(void) {
+    uint32_t save = save_and_disable_interrupts();
+    memset(&probe.stats, 0, sizeof(probe.stats));
+    restore_interrupts(save);
+}
+
+void audio_latency_on_take(audio_buffer_t *buffer) {
+    if (audio_latency_state != AUDIO_LATENCY_ARMED) return;
+    probe.take_us = time_us_32();
+    probe.buffer = buffer;
+    set_state(AUDIO_LATENCY_TAKEN);
+}
+
+void audio_latency_on_give(audio_buffer_t *buffer) {
+    if (audio_latency_state != AUDIO_LATENCY_TAKEN || buffer != probe.buffer) return;
+    if (buffer->sample_count < 2 || buffer->segments) {
+        // too short to carry the marker (or segmented); try again with the next buffer
+        set_state(AUDIO_LATENCY_ARMED);
+        return;
+    }
+    const audio_format_t *format = buffer->format->format;
+    uint channels = format->channel_count;
+    if (format->pcm_format == AUDIO_PCM_FORMAT_S16) {
+        int16_t *samples = (int16_t *) buffer->buffer->bytes;
+        for (uint c = 0; c < channels; c++) {
+            samples[c] = INT16_MIN;
+            samples[channels + c] = INT16_MAX;
+        }
+    } else if (format->pcm_format == AUDIO_PCM_FORMAT_F32) {
+        // converts to INT32_MIN / INT32_MAX on the way to the driver
+        float *samples = (float *) buffer->buffer->bytes;
+        for (uint c = 0; c < channels; c++) {
+            samples[c] = -1.0f;
+            samples[channels + c] = 1.0f;
+        }
+    } else {
+        int32_t *samples = (int32_t *) buffer->buffer->bytes;
+        for (uint c = 0; c < channels; c++) {
+            samples[c] = INT32_MIN;
+            samples[channels + c] = INT32_MAX;
+        }
+    }
+    set_state(AUDIO_LATENCY_STAMPED);
+}
+
+// the consumer side may have converted S16 to S32, so only the top 16 bits of
+// the positive half of the marker are relied upon
+static int find_marker(const audio_buffer_t *buffer) {
+    const audio_format_t *format = buffer->format->format;
+    uint channels = format->channel_count;
+    if (format->pcm_format == AUDIO_PCM_FORMAT_S16) {
+        const int16_t *samples = (const int16_t *) buffer->buffer->bytes;
+        for (uint i = 0; i + 1 < buffer->sample_count; i++) {
+            const int16_t *frame = samples + i * channels;
+            uint c;
+            for (c = 0; c < channels; c++) {
+                if (frame[c] != INT16_MIN || frame[channels + c] != INT16_MAX) break;
+            }
+            if (c == channels) return (int) i;
+        }
+    } else {
+        const int32_t *samples = (const int32_t *) buffer->buffer->bytes;
+        for (uint i = 0; i + 1 < buffer->sample_count; i++) {
+            const int32_t *frame = samples + i * channels;
+            uint c;
+            for (c = 0; c < channels; c++) {
+                if (frame[c] != INT32_MIN || frame[channels + c] < 0x7fff0000) break;
+            }
+            if (c == channels) return (int) i;
+        }
+    }
+    return -1;
+}
+
+static void record(uint32_t latency_us) {
+    audio_latency_stats_t *stats = &probe.stats;
+    stats->count++;
+    stats->total_us += latency_us;
+    if (stats->count == 1 || latency_us < stats->min_us) stats->min_us = latency_us;
+    if (latency_us > stats->max_us) stats->max_us = latency_us;
+    uint bin = MIN(latency_us / PICO_AUDIO_LATENCY_BIN_US, PICO_AUDIO_LATENCY_HISTOGRAM_BINS - 1);
+    stats->histogram[bin]++;
+}
+
+bool audio_latency_check_buffer(const audio_buffer_t *buffer, uint32_t now_us) {
+    switch (audio_latency_state) {
+        case AUDIO_LATENCY_QUEUED:
+            // the transfer queued last time starts now
+            record(now_us + probe.pin_offset_us - probe.take_us);
+            next_probe();
+            return true;
+        case AUDIO_LATENCY_STAMPED:
+            if (buffer) {
+                int offset = find_marker(buffer);
+                if (offset >= 0) {
+                    probe.pin_offset_us = (uint32_t) ((uint64_t) offset * 1000000u /
+                                                      buffer->format->format->sample_freq);
+                    set_state(AUDIO_LATENCY_QUEUED);
+                    return false;
+                }
+            }
+            // fall through
+        case AUDIO_LATENCY_TAKEN:
+            if (now_us - probe.take_us > AUDIO_LATENCY_LOST_TIMEOUT_US) {
+                probe.stats.lost++;
+                set_state(AUDIO_LATENCY_ARMED);
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+void audio_latency_get_stats(audio_latency_stats_t *stats) {
+    uint32_t save = save_and_disable_interrupts();
+    *stats = probe.stats;
+    restore_interrupts(save);
+}
+
+void audio_latency_print_report(void) {
+    audio_latency_stats_t stats;
+    audio_latency_get_stats(&stats);
+    printf("audio_latency: %u probes, %u lost\n", (uint) stats.count, (uint) stats.lost);
+    if (!stats.count) return;
+    printf("  min %u us, mean %u us, max %u us\n", (uint) stats.min_us,
+           (uint) (stats.total_us / stats.count), (uint) stats.max_us);
+    for (uint bin = 0; bin < PICO_AUDIO_LATENCY_HISTOGRAM_BINS; bin++) {
+        if (!stats.histogram[bin]) continue;
+        if (bin == PICO_AUDIO_LATENCY_HISTOGRAM_BINS - 1) {
+            printf("  >=%5u us: %u\n", bin * PICO_AUDIO_LATENCY_BIN_US, (uint) stats.histogram[bin]);
+        } else {
+            printf("  %7u us: %u\n", bin * PICO_AUDIO_LATENCY_BIN_US, (uint) stats.histogram[bin]);
+        }
+    }
+}
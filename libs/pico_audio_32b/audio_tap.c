@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file audio_tap.c
+ * @brief Tap ring: blocks of the selected tap point, framed for streaming
+ *
+ * head and tail are free running byte counts; head is only moved by a writer
+ * holding write_lock, tail only by the single reader, so the reader never
+ * takes the lock. For the same reason audio_tap_select() cannot empty the ring
+ * itself: it records where the new selection starts and the reader skips to
+ * there, once it has finished the block it is in the middle of, so the stream
+ * it hands out never contains a partial block.
+ */
+
+#include <string.h>
+#include "pico/audio_tap.h"
+#include "hardware/sync.h"
+
+#define RING_MASK (PICO_AUDIO_TAP_RING_SIZE - 1)
+
+volatile uint8_t audio_tap_selected = AUDIO_TAP_NONE;
+
+static uint8_t ring[PICO_AUDIO_TAP_RING_SIZE];
+static volatile uint32_t head;      // bytes written
+static volatile uint32_t tail;      // bytes read
+static spin_lock_t *write_lock;
+static uint32_t sequence;           // of the selected tap
+static uint8_t generation;          // audio_tap_select() calls
+static uint32_t dropped;
+// set by audio_tap_select(): the reader drops everything before flush_head
+static volatile uint32_t flush_head;
+static volatile bool flush_pending;
+static uint32_t block_end;          // reader: end of the block tail is in (== tail between blocks)
+
+static uint bytes_per_sample(audio_pcm_format_t pcm_format) {
+    switch (pcm_format) {
+        case AUDIO_PCM_FORMAT_S8:
+        case AUDIO_PCM_FORMAT_U8:
+            return 1;
+        case AUDIO_PCM_FORMAT_S16:
+        case AUDIO_PCM_FORMAT_U16:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+static void ring_put(uint32_t pos, const void *src, uint len) {
+    uint offset = pos & RING_MASK;
+    uint first = MIN(len, PICO_AUDIO_TAP_RING_SIZE - offset);
+    memcpy(ring + offset, src, first);
+    memcpy(ring, (const uint8_t *) src + first, len - first);
+}
+
+static void ring_get(uint32_t pos, void *dst, uint len) {
+    uint offset = pos & RING_MASK;
+    uint first = MIN(len, PICO_AUDIO_TAP_RING_SIZE - offset);
+    memcpy(dst, ring + offset, first);
+    memcpy((uint8_t *) dst + first, ring, len - first);
+}
+
+void audio_tap_init(void) {
+    if (!write_lock) write_lock = spin_lock_init(spin_lock_claim_unused(true));
+}
+
+void audio_tap_select(uint tap) {
+    audio_tap_init();
+    uint32_t save = spin_lock_blocking(write_lock);
+    sequence = 0;
+    generation++;
+    audio_tap_selected = (uint8_t) tap;
+    flush_head = head;
+    __mem_fence_release();
+    flush_pending = true;
+    spin_unlock(write_lock, save);
+}
+
+uint8_t audio_tap_get_generation(void) {
+    return generation;
+}
+
+void audio_tap_write_block(uint tap, const audio_format_t *format, const void *frames, uint frame_count) {
+    if (!write_lock) return;
+    frame_count = MIN(frame_count, UINT16_MAX);
+    uint bytes = frame_count * format->channel_count * bytes_per_sample(format->pcm_format);
+    audio_tap_block_header_t header = {
+            .magic = AUDIO_TAP_MAGIC,
+            .tap = (uint8_t) tap,
+            .pcm_format = (uint8_t) format->pcm_format,
+            .channel_count = (uint8_t) format->channel_count,
+            .frame_count = (uint16_t) frame_count,
+            .sample_freq = format->sample_freq,
+    };
+    uint32_t save = spin_lock_blocking(write_lock);
+    // selection may have changed since the unlocked check in audio_tap_write()
+    if (audio_tap_selected == tap) {
+        header.sequence = sequence++;
+        header.generation = generation;
+        uint32_t pos = head;
+        uint32_t used = pos - tail;
+        __mem_fence_acquire();
+        if (sizeof(header) + bytes <= PICO_AUDIO_TAP_RING_SIZE - used) {
+            ring_put(pos, &header, sizeof(header));
+            ring_put(pos + sizeof(header), frames, bytes);
+            __mem_fence_release();
+            head = pos + sizeof(header) + bytes;
+        } else {
+            dropped++;
+        }
+    }
+    spin_unlock(write_lock, save);
+}
+
+// reader, between blocks: skip what audio_tap_select() discarded, then find the end of the next block
+static void next_block(void) {
+    if (flush_pending) {
+        flush_pending = false;
+        __mem_fence_acquire();
+        // a later select only moves flush_head further
+        uint32_t pos = flush_head;
+        if ((int32_t) (pos - tail) > 0) tail = block_end = pos;
+    }
+    uint32_t pos = tail;
+    if (head - pos < sizeof(audio_tap_block_header_t)) return;
+    __mem_fence_acquire();
+    // writers publish whole blocks, so once the header is there the block is complete
+    audio_tap_block_header_t header;
+    ring_get(pos, &header, sizeof(header));
+    block_end = pos + sizeof(header) + header.frame_count * header.channel_count * bytes_per_sample(header.pcm_format);
+}
+
+uint audio_tap_read(uint8_t *dst, uint max_bytes) {
+    uint done = 0;
+    while (done < max_bytes) {
+        if (tail == block_end) {
+            next_block();
+            if (tail == block_end) break;
+        }
+        uint32_t pos = tail;
+        uint len = MIN(max_bytes - done, block_end - pos);
+        ring_get(pos, dst + done, len);
+        __mem_fence_release();
+        tail = pos + len;
+        done += len;
+    }
+    return done;
+}
+
+// only looks: audio_tap_usb_poll() checks this with the USB IRQ (the reader) still enabled
+uint audio_tap_available(void) {
+    uint32_t pos = tail;
+    if (!flush_pending) return head - pos;
+    __mem_fence_acquire();
+    uint32_t start = flush_head;
+    // the rest of the current block, then what the select kept
+    if (pos != block_end) return block_end - pos + head - start;
+    return head - ((int32_t) (start - pos) > 0 ? start : pos);
+}
+
+uint32_t audio_tap_get_dropped(void) {
+    return dropped;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file audio_tap_usb.c
+ * @brief USB vendor device streaming the tap ring over a bulk IN endpoint
+ *
+ * The endpoint runs one long usb_stream_transfer, restarted whenever it
+ * completes. Its chunks are filled straight from the ring in the USB IRQ; a
+ * chunk the ring cannot fill yet is left pending (the endpoint NAKs) and
+ * completed later by audio_tap_usb_poll().
+ */
+
+#include "pico/audio_tap.h"
+#include "pico/usb_device.h"
+#include "pico/usb_stream_helper.h"
+#include "hardware/irq.h"
+
+#define TAP_INTERFACE 0
+#define TAP_EP_IN (USB_DIR_IN | 1u)
+#define TAP_PACKET_SIZE 64u
+#define TAP_CHUNK_SIZE 512u
+// restarted on completion, so this only bounds the packet counters
+#define TAP_STREAM_LENGTH (TAP_CHUNK_SIZE * 0x8000u)
+
+static const struct usb_device_descriptor tap_device_descriptor = {
+        .bLength = sizeof(struct usb_device_descriptor),
+        .bDescriptorType = USB_DT_DEVICE,
+        .bcdUSB = 0x0110,
+        .bDeviceClass = 0,              // per interface
+        .bDeviceSubClass = 0,
+        .bDeviceProtocol = 0,
+        .bMaxPacketSize0 = 64,
+        .idVendor = PICO_AUDIO_TAP_USB_VID,
+        .idProduct = PICO_AUDIO_TAP_USB_PID,
+        .bcdDevice = 0x0100,
+        .iManufacturer = 1,
+        .iProduct = 2,
+        .iSerialNumber = 0,
+        .bNumConfigurations = 1,
+};
+
+static const struct tap_config_descriptor {
+    struct usb_configuration_descriptor config;
+    struct usb_interface_descriptor interface;
+    struct usb_endpoint_descriptor ep_in;
+} __packed tap_config_descriptor = {
+        .config = {
+                .bLength = sizeof(struct usb_configuration_descriptor),
+                .bDescriptorType = USB_DT_CONFIG,
+                .wTotalLength = sizeof(struct tap_config_descriptor),
+                .bNumInterfaces = 1,
+                .bConfigurationValue = 1,
+                .iConfiguration = 0,
+                .bmAttributes = 0x80,   // bus powered
+                .bMaxPower = 50,        // 100 mA
+        },
+        .interface = {
+                .bLength = sizeof(struct usb_interface_descriptor),
+                .bDescriptorType = USB_DT_INTERFACE,
+                .bInterfaceNumber = TAP_INTERFACE,
+                .bAlternateSetting = 0,
+                .bNumEndpoints = 1,
+                .bInterfaceClass = 0xff, // vendor specific
+                .bInterfaceSubClass = 0,
+                .bInterfaceProtocol = 0,
+                .iInterface = 2,
+        },
+        .ep_in = {
+                .bLength = sizeof(struct usb_endpoint_descriptor),
+                .bDescriptorType = USB_DT_ENDPOINT,
+                .bEndpointAddress = TAP_EP_IN,
+                .bmAttributes = USB_TRANSFER_TYPE_BULK,
+                .wMaxPacketSize = TAP_PACKET_SIZE,
+                .bInterval = 0,
+        },
+};
+
+static struct usb_interface tap_interface;
+static struct usb_endpoint tap_ep_in;
+static struct usb_endpoint *const tap_endpoints[] = {&tap_ep_in};
+static struct usb_interface *const tap_interfaces[] = {&tap_interface};
+
+// alternated, so a restart from the completion callback never reuses the transfer just completed
+static struct usb_stream_transfer tap_streams[2];
+static struct usb_stream_transfer *tap_stream;
+static uint8_t tap_chunk[TAP_CHUNK_SIZE];
+// chunk waiting for data (0 = none); only changed with the USB IRQ masked or from it
+static volatile uint32_t pending_chunk_len;
+static bool tap_configured;
+
+static const char *tap_get_descriptor_string(uint index) {
+    return index == 1 ? "Raspberry Pi" : "Pico Audio Tap";
+}
+
+static bool tap_on_chunk(uint32_t chunk_len, __unused struct usb_stream_transfer *transfer) {
+    if (audio_tap_available() >= chunk_len) {
+        audio_tap_read(tap_chunk, chunk_len);
+        return false;
+    }
+    pending_chunk_len = chunk_len;
+    return true;
+}
+
+static const struct usb_stream_transfer_funcs tap_stream_funcs = {
+        .on_packet_complete = usb_stream_noop_on_packet_complete,
+        .on_chunk = tap_on_chunk,
+};
+
+static void tap_start_stream(void);
+
+static void tap_on_stream_complete(__unused struct usb_endpoint *ep, __unused struct usb_transfer *transfer) {
+    tap_start_stream();
+}
+
+static void tap_start_stream(void) {
+    pending_chunk_len = 0;
+    tap_stream = tap_stream == &tap_streams[0] ? &tap_streams[1] : &tap_streams[0];
+    usb_stream_setup_transfer(tap_stream, &tap_stream_funcs, tap_chunk, TAP_CHUNK_SIZE, TAP_STREAM_LENGTH,
+                              tap_on_stream_complete);
+    tap_stream->ep = &tap_ep_in;
+    usb_start_transfer(&tap_ep_in, &tap_stream->core);
+}
+
+static void tap_on_stall_change(struct usb_endpoint *ep) {
+    // CLEAR_FEATURE(HALT) resets the endpoint, dropping the transfer
+    pending_chunk_len = 0;
+    if (tap_configured && !usb_is_endpoint_stalled(ep) && !ep->current_transfer) tap_start_stream();
+}
+
+static void tap_on_configure(__unused struct usb_device *device, bool configured) {
+    pending_chunk_len = 0;
+    tap_configured = configured;
+    if (configured) tap_start_stream();
+}
+
+static bool tap_setup_request_handler(__unused struct usb_interface *interface, struct usb_setup_packet *setup) {
+    setup = __builtin_assume_aligned(setup, 4);
+    if ((setup->bmRequestType & USB_REQ_TYPE_TYPE_MASK) != USB_REQ_TYPE_TYPE_VENDOR) return false;
+    if (!(setup->bmRequestType & USB_DIR_IN) && setup->bRequest == AUDIO_TAP_USB_REQUEST_SELECT &&
+        !setup->wLength) {
+        audio_tap_select(setup->wValue);
+        usb_start_empty_control_in_transfer_null_completion();
+        return true;
+    }
+    if ((setup->bmRequestType & USB_DIR_IN) && setup->bRequest == AUDIO_TAP_USB_REQUEST_GET_GENERATION &&
+        setup->wLength >= 1) {
+        usb_start_tiny_control_in_transfer(audio_tap_get_generation(), 1);
+        return true;
+    }
+    return false;
+}
+
+void audio_tap_usb_init(void) {
+    audio_tap_init();
+    usb_interface_init(&tap_interface, &tap_config_descriptor.interface, tap_endpoints, count_of(tap_endpoints), true);
+    tap_interface.setup_request_handler = tap_setup_request_handler;
+    tap_ep_in.on_stall_change = tap_on_stall_change;
+    struct usb_device *device = usb_device_init(&tap_device_descriptor, &tap_config_descriptor.config,
+                                                tap_interfaces, count_of(tap_interfaces),
+                                                tap_get_descriptor_string);
+    device->on_configure = tap_on_configure;
+    usb_device_start();
+}
+
+void audio_tap_usb_poll(void) {
+    if (!pending_chunk_len || audio_tap_available() < pending_chunk_len) return;
+    irq_set_enabled(USBCTRL_IRQ, false);
+    // the IRQ may have reset the endpoint in the meantime
+    uint32_t chunk_len = pending_chunk_len;
+    if (chunk_len && audio_tap_available() >= chunk_len) {
+        audio_tap_read(tap_chunk, chunk_len);
+        pending_chunk_len = 0;
+        usb_stream_chunk_done(tap_stream);
+    }
+    irq_set_enabled(USBCTRL_IRQ, true);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file audio_trace.c
+ * @brief Per-core event trace rings for the audio pipeline
+ *
+ * Recording is done inline by audio_trace() in pico/audio_trace.h; this file
+ * only owns the ring storage and the dump/reset helpers.
+ */
+
+#include <stdio.h>
+#include "pico/audio_trace.h"
+
+static const char *const audio_trace_event_names[AUDIO_TRACE_USER] = {
+    "dma_irq_enter",
+    "dma_irq_exit",
+    "buffer_take",
+    "buffer_give",
+    "render_start",
+    "render_stop",
+    "underrun",
+};
+
+audio_trace_ring_t audio_trace_rings[NUM_CORES];
+volatile bool audio_trace_enabled = PICO_AUDIO_TRACE;
+
+void audio_trace_set_enabled(bool enabled) {
+    audio_trace_enabled = enabled;
+    __mem_fence_release();
+}
+
+void audio_trace_reset(void) {
+    bool was_enabled = audio_trace_enabled;
+    audio_trace_set_enabled(false);
+    for (uint core = 0; core < NUM_CORES; core++) {
+        audio_trace_rings[core].head = 0;
+    }
+    audio_trace_set_enabled(was_enabled);
+}
+
+void audio_trace_dump(void) {
+    bool was_enabled = audio_trace_enabled;
+    audio_trace_set_enabled(false);
+
+    printf("# audio_trace begin\n");
+    printf("core,timestamp_us,event,arg,name\n");
+    for (uint core = 0; core < NUM_CORES; core++) {
+        const audio_trace_ring_t *ring = &audio_trace_rings[core];
+        uint32_t head = ring->head;
+        // oldest record first; once the ring has wrapped only the last N are valid
+        uint32_t count = MIN(head, PICO_AUDIO_TRACE_BUFFER_SIZE);
+        for (uint32_t i = head - count; i != head; i++) {
+            const audio_trace_record_t *record = &ring->records[i & (PICO_AUDIO_TRACE_BUFFER_SIZE - 1)];
+            const char *name = record->event < AUDIO_TRACE_USER ? audio_trace_event_names[record->event] : "user";
+            printf("%u,%u,%u,%u,%s\n", core, (uint) record->timestamp, record->event, record->arg, name);
+        }
+    }
+    printf("# audio_trace end\n");
+
+    audio_trace_set_enabled(was_enabled);
+}
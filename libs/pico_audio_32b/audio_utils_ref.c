@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file audio_utils_ref.c
+ * @brief Portable C implementation of the audio_upsample kernels
+ *
+ * This defines the arithmetic the assembler versions implement, and is the
+ * implementation used for host (PICO_NO_HARDWARE) builds. tests/audio_upsample_test.c
+ * checks it against the blend definition below on the host.
+ *
+ * For every output sample the position pos (in 1/0x1000 input samples,
+ * starting at 0 and advancing by step) selects input[pos >> 12] and
+ * input[(pos >> 12) + 1], which are blended with the 8 bit weight
+ * alpha = (pos >> 4) & 0xff:
+ *
+ *     out = s0 + (((s1 - s0) * alpha) >> 8)       (arithmetic shift)
+ *
+ * which is the linear interpolation the RP2040 interpolator performs in blend
+ * mode. The M33 and Hazard3 versions are written to compute the same values;
+ * being assembler for the target, they are not covered by the host test.
+ */
+
+#include "pico/audio.h"
+
+#define AUDIO_UPSAMPLE_SCALE_BITS 12
+
+static inline int16_t upsample_one(const int16_t *input, uint32_t pos) {
+    const int16_t *s = input + (pos >> AUDIO_UPSAMPLE_SCALE_BITS);
+    int32_t alpha = (int32_t) ((pos >> (AUDIO_UPSAMPLE_SCALE_BITS - 8)) & 0xff);
+    return (int16_t) (s[0] + (((s[1] - s[0]) * alpha) >> 8));
+}
+
+void audio_upsample(int16_t *input, int16_t *output, uint output_count, uint32_t step) {
+    uint32_t pos = 0;
+    for (uint i = 0; i < output_count; i++) {
+        output[i] = upsample_one(input, pos);
+        pos += step;
+    }
+}
+
+void audio_upsample_words(int16_t *input, int16_t *output_aligned, uint output_word_count, uint32_t step) {
+    audio_upsample(input, output_aligned, output_word_count * 2, step);
+}
+
+void audio_upsample_double(int16_t *input, int16_t *output, uint output_count, uint32_t step) {
+    uint32_t pos = 0;
+    for (uint i = 0; i < output_count; i++) {
+        int16_t sample = upsample_one(input, pos);
+        output[i * 2] = sample;
+        output[i * 2 + 1] = sample;
+        pos += step;
+    }
+}
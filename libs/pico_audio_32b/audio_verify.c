@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file audio_verify.c
+ * @brief Test signal generator and continuity checker for soak tests
+ *
+ * See pico/audio_verify.h for the test signal definition. All state lives in
+ * one static instance because there is only one output stream to verify.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/audio_verify.h"
+
+static struct {
+    audio_verify_config_t config;
+    audio_verify_report_t report;
+    uint64_t frame_index;       // stream position of the next frame to check
+    uint32_t last_sample;       // channel 0 of the last frame checked
+    bool have_last_sample;
+    // buffer start jitter: interval between two checks is the duration of the
+    // buffer checked two calls earlier (one is playing while the next is queued)
+    uint32_t last_check_us;
+    uint32_t queued_duration_us[2];
+    uint8_t history;            // number of valid entries in queued_duration_us
+    bool started;
+} verify;
+
+static void log_event(audio_verify_event_kind_t kind, uint32_t now_us, uint32_t count) {
+    audio_verify_report_t *report = &verify.report;
+    audio_verify_event_t *event = &report->events[report->event_count % PICO_AUDIO_VERIFY_EVENT_LOG_SIZE];
+    event->timestamp_us = now_us;
+    event->frame = (uint32_t) verify.frame_index;
+    event->count = count;
+    event->kind = (uint8_t) kind;
+    report->event_count++;
+}
+
+void audio_verify_start(const audio_verify_config_t *config) {
+    uint32_t save = save_and_disable_interrupts();
+    memset(&verify, 0, sizeof(verify));
+    verify.config = *config;
+    if (!verify.config.step) verify.config.step = 1;
+    verify.started = true;
+    restore_interrupts(save);
+}
+
+void audio_verify_generate_frames(void *samples, audio_pcm_format_t pcm_format, uint channel_count,
+                                  uint frame_count, uint32_t *phase, uint32_t step) {
+    uint32_t p = *phase;
+    if (pcm_format == AUDIO_PCM_FORMAT_S16) {
+        int16_t *out = (int16_t *) samples;
+        for (uint i = 0; i < frame_count; i++) {
+            for (uint c = 0; c < channel_count; c++) *out++ = (int16_t) p;
+            p += step;
+        }
+    } else {
+        assert(pcm_format == AUDIO_PCM_FORMAT_S32);
+        int32_t *out = (int32_t *) samples;
+        for (uint i = 0; i < frame_count; i++) {
+            for (uint c = 0; c < channel_count; c++) *out++ = (int32_t) p;
+            p += step;
+        }
+    }
+    *phase = p;
+}
+
+void audio_verify_generate(audio_buffer_t *buffer, uint32_t *phase, uint32_t step) {
+    const audio_format_t *format = buffer->format->format;
+    audio_verify_generate_frames(buffer->buffer->bytes, format->pcm_format, format->channel_count,
+                                 buffer->max_sample_count, phase, step);
+    buffer->sample_count = buffer->max_sample_count;
+}
+
+static inline uint32_t read_sample(const void *samples, uint index, bool s16) {
+    return s16 ? (uint16_t) ((const int16_t *) samples)[index] : (uint32_t) ((const int32_t *) samples)[index];
+}
+
+static void check_timing(uint32_t duration_us, uint32_t now_us) {
+    if (verify.history == 2) {
+        uint32_t interval = now_us - verify.last_check_us;
+        uint32_t expected = verify.queued_duration_us[0];
+        uint32_t error = interval > expected ? interval - expected : expected - interval;
+        if (error > verify.report.max_jitter_us) verify.report.max_jitter_us = error;
+        if (error > verify.config.jitter_tolerance_us) {
+            verify.report.jitter_violations++;
+            log_event(AUDIO_VERIFY_JITTER, now_us, error);
+        }
+    } else {
+        verify.history++;
+    }
+    verify.queued_duration_us[0] = verify.queued_duration_us[1];
+    verify.queued_duration_us[1] = duration_us;
+    verify.last_check_us = now_us;
+}
+
+void audio_verify_check_buffer(const audio_buffer_t *buffer, uint32_t now_us) {
+    audio_verify_report_t *report = &verify.report;
+    if (!verify.started) return;
+    if (!buffer) {
+        report->underruns++;
+        log_event(AUDIO_VERIFY_UNDERRUN, now_us, 0);
+        // the silence buffer still occupies the output; its length is not known
+        // here, so restart the timing history rather than flag a false jitter
+        verify.history = 0;
+        return;
+    }
+
+    const audio_format_t *format = buffer->format->format;
+    bool s16 = format->pcm_format == AUDIO_PCM_FORMAT_S16;
+    uint32_t mask = s16 ? 0xffffu : 0xffffffffu;
+    uint32_t step = verify.config.step & mask;
+    // e.g. step 0x10000 on S16: the ramp is constant in this width; keep the division defined
+    if (!step) step = 1;
+    uint channels = format->channel_count;
+    const void *samples = buffer->buffer->bytes;
+
+    for (uint i = 0; i < buffer->sample_count; i++) {
+        uint32_t sample = read_sample(samples, i * channels, s16);
+        for (uint c = 1; c < channels; c++) {
+            if (read_sample(samples, i * channels + c, s16) != sample) {
+                report->discontinuities++;
+                log_event(AUDIO_VERIFY_DISCONTINUITY, now_us, c);
+                break;
+            }
+        }
+        if (verify.have_last_sample) {
+            uint32_t delta = (sample - verify.last_sample) & mask;
+            if (delta != step) {
+                if (!delta) {
+                    report->repeated_frames++;
+                    log_event(AUDIO_VERIFY_REPEATED, now_us, 1);
+                } else if (!(delta % step) && delta / step - 1 <= verify.config.max_missing_frames) {
+                    uint32_t missing = delta / step - 1;
+                    report->missing_frames += missing;
+                    log_event(AUDIO_VERIFY_MISSING, now_us, missing);
+                } else {
+                    report->discontinuities++;
+                    log_event(AUDIO_VERIFY_DISCONTINUITY, now_us, delta);
+                }
+            }
+        }
+        verify.last_sample = sample;
+        verify.have_last_sample = true;
+        verify.frame_index++;
+    }
+
+    report->frames_checked += buffer->sample_count;
+    report->buffers_checked++;
+    check_timing((uint32_t) ((uint64_t) buffer->sample_count * 1000000u / format->sample_freq), now_us);
+}
+
+void audio_verify_get_report(audio_verify_report_t *report) {
+    uint32_t save = save_and_disable_interrupts();
+    *report = verify.report;
+    restore_interrupts(save);
+}
+
+bool audio_verify_passed(void) {
+    const audio_verify_report_t *report = &verify.report;
+    return !report->discontinuities && !report->repeated_frames && !report->missing_frames &&
+           !report->underruns && !report->jitter_violations;
+}
+
+void audio_verify_print_report(void) {
+    static const char *const kind_names[] = {"discontinuity", "repeated", "missing", "underrun", "jitter"};
+    audio_verify_report_t report;
+    audio_verify_get_report(&report);
+
+    printf("audio_verify: %llu frames in %u buffers\n", (unsigned long long) report.frames_checked,
+           (uint) report.buffers_checked);
+    printf("  discontinuities %u, repeated %u, missing %u, underruns %u, jitter %u (max %u us)\n",
+           (uint) report.discontinuities, (uint) report.repeated_frames, (uint) report.missing_frames,
+           (uint) report.underruns, (uint) report.jitter_violations, (uint) report.max_jitter_us);
+    uint32_t logged = MIN(report.event_count, PICO_AUDIO_VERIFY_EVENT_LOG_SIZE);
+    for (uint32_t i = report.event_count - logged; i != report.event_count; i++) {
+        const audio_verify_event_t *event = &report.events[i % PICO_AUDIO_VERIFY_EVENT_LOG_SIZE];
+        printf("  [%u us] frame %u: %s (%u)\n", (uint) event->timestamp_us, (uint) event->frame,
+               kind_names[event->kind], (uint) event->count);
+    }
+    printf("audio_verify: %s\n", audio_verify_passed() ? "PASS" : "FAIL");
+}
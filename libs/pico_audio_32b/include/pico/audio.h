@@ -45,7 +45,8 @@ typedef enum {
     AUDIO_PCM_FORMAT_S8,         ///< signed 8bit PCM
     AUDIO_PCM_FORMAT_U32,        ///< unsigned 16bit PCM
     AUDIO_PCM_FORMAT_U16,        ///< unsigned 16bit PCM
-    AUDIO_PCM_FORMAT_U8          ///< unsigned 16bit PCM
+    AUDIO_PCM_FORMAT_U8,         ///< unsigned 16bit PCM
+    AUDIO_PCM_FORMAT_F32         ///< 32bit float PCM, nominal range [-1.0, 1.0)
 } audio_pcm_format_t;
 
 typedef enum {
@@ -68,6 +69,13 @@ typedef struct audio_buffer_format {
     uint16_t sample_stride;                 ///< Sample stride
 } audio_buffer_format_t;
 
+/** \brief One contiguous fragment of a segmented audio buffer
+ */
+typedef struct audio_buffer_segment {
+    uint8_t *bytes;                 ///< Sample data (word aligned for DMA)
+    uint32_t sample_count;          ///< Number of samples (frames) in this fragment
+} audio_buffer_segment_t;
+
 /** \brief Audio buffer definition
  */
 typedef struct audio_buffer {
@@ -76,12 +84,79 @@ typedef struct audio_buffer {
     uint32_t sample_count;
     uint32_t max_sample_count;
     uint32_t user_data; // only valid while the user has the buffer
+    // when non NULL the samples are in these fragments rather than in buffer; see audio_buffer_set_segments()
+    const audio_buffer_segment_t *segments;
+    uint32_t segment_count;
     // private - todo make an internal version
     struct audio_buffer *next;
 } audio_buffer_t;
 
+/** \brief Timeout for audio_stream_write()/audio_stream_read() that never expires
+ */
+#define AUDIO_STREAM_WAIT_FOREVER 0xffffffffu
+
+/*! \brief Point a buffer at fragmented sample data instead of its own memory
+ *  \ingroup pico_audio
+ *
+ * Lets a decoder or streaming source give data that sits in several places
+ * (SD sectors, USB packets) without first gathering it into buffer->bytes.
+ * sample_count becomes the total of all fragments. The copying connections
+ * read across the fragments, and the I2S driver plays them one DMA transfer
+ * per fragment with no copy at all (see audio_i2s_connect_passthru()).
+ *
+ * The segment array and the data must stay valid until the buffer comes back
+ * from the pool's free list; the fragments are forgotten when it is freed.
+ *
+ * \param buffer Buffer taken from a producer pool
+ * \param segments Fragments, in playing order
+ * \param segment_count Number of fragments
+ */
+static inline void audio_buffer_set_segments(audio_buffer_t *buffer, const audio_buffer_segment_t *segments,
+                                             uint segment_count) {
+    buffer->segments = segments;
+    buffer->segment_count = segment_count;
+    buffer->sample_count = 0;
+    for (uint i = 0; i < segment_count; i++) {
+        buffer->sample_count += segments[i].sample_count;
+    }
+}
+
+/*! \brief Address of a sample in a plain or segmented buffer
+ *  \ingroup pico_audio
+ *
+ * \param buffer Buffer to read
+ * \param pos Sample (frame) index from the start of the buffer
+ * \param contiguous Receives how many samples from pos on are contiguous in memory
+ * \return Pointer to the sample at pos, or NULL (with *contiguous = 0) past the end
+ */
+static inline uint8_t *audio_buffer_bytes_at(const audio_buffer_t *buffer, uint32_t pos, uint32_t *contiguous) {
+    uint stride = buffer->format->sample_stride;
+    if (!buffer->segments) {
+        *contiguous = pos < buffer->sample_count ? buffer->sample_count - pos : 0;
+        return buffer->buffer->bytes + pos * stride;
+    }
+    for (uint i = 0; i < buffer->segment_count; i++) {
+        const audio_buffer_segment_t *segment = &buffer->segments[i];
+        if (pos < segment->sample_count) {
+            *contiguous = segment->sample_count - pos;
+            return segment->bytes + pos * stride;
+        }
+        pos -= segment->sample_count;
+    }
+    *contiguous = 0;
+    return NULL;
+}
+
 typedef struct audio_connection audio_connection_t;
 
+/** \brief Single producer ring of prepared buffers, one per core in a multi-producer pool (private)
+ */
+typedef struct audio_prepared_ring {
+    audio_buffer_t **slots;
+    volatile uint32_t head;     ///< next slot to read; written by the consumer only
+    volatile uint32_t tail;     ///< next slot to fill; written by the owning core only
+} audio_prepared_ring_t;
+
 typedef struct audio_buffer_pool {
     enum {
         ac_producer, ac_consumer
@@ -95,6 +170,12 @@ typedef struct audio_buffer_pool {
     spin_lock_t *prepared_list_spin_lock;
     audio_buffer_t *prepared_list;
     audio_buffer_t *prepared_list_tail;
+    // ----- multi-producer pools only (NULL otherwise), see audio_new_mpsc_producer_pool() -----
+    audio_prepared_ring_t *prepared_rings; // NUM_CORES rings, used instead of prepared_list
+    uint32_t prepared_ring_mask;
+    uint8_t prepared_ring_next;            // ring the consumer looks at first
+    // buffer partly written/read by audio_stream_write()/audio_stream_read(), held by the pool's user
+    audio_buffer_t *stream_buffer;
 } audio_buffer_pool_t;
 
 typedef struct audio_connection audio_connection_t;
@@ -123,6 +204,73 @@ struct audio_connection {
 audio_buffer_pool_t *audio_new_producer_pool(audio_buffer_format_t *format, int buffer_count,
                                                          int buffer_sample_count);
 
+/*! \brief Allocate and initialise an audio producer pool that both cores can give to
+ *  \ingroup pico_audio
+ *
+ * Like audio_new_producer_pool(), but full buffers are queued on a lock-free
+ * single producer ring per core instead of the spin lock protected prepared
+ * list, so producers on core0 and core1 never wait on each other (or on the
+ * consumer). The consumer takes from the rings in turn; buffers from one core
+ * stay in the order they were given, buffers from different cores interleave.
+ *
+ * Each core may have only one producing context (e.g. not both a thread and an
+ * IRQ on the same core), and there must be a single consumer, which is the
+ * case for the I2S connection (audio_i2s_connect() without buffer_on_give).
+ * Taking free buffers still goes through the free list spin lock, which is only
+ * held for a couple of pointer updates.
+ *
+ * \param format Format of the audio buffer
+ * \param buffer_count Number of buffers shared by all producers
+ * \param buffer_sample_count Number of samples per buffer
+ * \return Pointer to an audio_buffer_pool
+ */
+audio_buffer_pool_t *audio_new_mpsc_producer_pool(audio_buffer_format_t *format, int buffer_count,
+                                                  int buffer_sample_count);
+
+/*! \brief Write any number of frames to a producer pool
+ *  \ingroup pico_audio
+ *
+ * Copies frames (in the pool's format) into the buffer the stream is filling,
+ * giving each buffer to the connection as soon as it is full and taking the
+ * next, so decoder block sizes need not match pool buffer sizes. Any format
+ * conversion still happens once, in the connection. A partly filled buffer is
+ * kept for the next call; audio_stream_flush() gives it early.
+ *
+ * Do not mix with take_audio_buffer()/give_audio_buffer() on the same pool
+ * from another context while a buffer is held.
+ *
+ * \param pool Producer pool
+ * \param frames Source frames, packed at the pool's sample stride
+ * \param frame_count Number of frames to write
+ * \param timeout_us How long to wait for free buffers in total: 0 to not wait,
+ *        AUDIO_STREAM_WAIT_FOREVER to block
+ * \return Number of frames written, less than frame_count only on timeout
+ */
+uint audio_stream_write(audio_buffer_pool_t *pool, const void *frames, uint frame_count, uint32_t timeout_us);
+
+/*! \brief Give the partly written stream buffer now
+ *  \ingroup pico_audio
+ *
+ * \param pool Producer pool written with audio_stream_write()
+ */
+void audio_stream_flush(audio_buffer_pool_t *pool);
+
+/*! \brief Read any number of frames from a consumer pool
+ *  \ingroup pico_audio
+ *
+ * Counterpart of audio_stream_write() for capture: takes full buffers from
+ * the pool, copies out as many frames as asked for and returns each buffer
+ * once it has been read completely.
+ *
+ * \param pool Consumer pool
+ * \param frames Destination, packed at the pool's sample stride
+ * \param frame_count Number of frames to read
+ * \param timeout_us How long to wait for data in total: 0 to not wait,
+ *        AUDIO_STREAM_WAIT_FOREVER to block
+ * \return Number of frames read, less than frame_count only on timeout
+ */
+uint audio_stream_read(audio_buffer_pool_t *pool, void *frames, uint frame_count, uint32_t timeout_us);
+
 /*! \brief Allocate and initialise an audio consumer pool
  *  \ingroup pico_audio
  *
@@ -134,6 +282,26 @@ audio_buffer_pool_t *audio_new_producer_pool(audio_buffer_format_t *format, int
 audio_buffer_pool_t *audio_new_consumer_pool(audio_buffer_format_t *format, int buffer_count,
                                                          int buffer_sample_count);
 
+/*! \brief Initialise a producer or consumer pool in caller-provided (typically static) storage
+ *  \ingroup pico_audio
+ *
+ * Nothing is allocated from the heap, so the memory shows up in the map file.
+ * pico/audio_i2s_pipeline.h declares the storage for a whole I2S pipeline at
+ * compile time and calls this.
+ *
+ * \param pool Pool to initialise
+ * \param consumer true for a consumer pool, false for a producer pool
+ * \param format Format of the audio buffers
+ * \param buffers buffer_count audio buffers
+ * \param mem_buffers buffer_count memory buffer descriptors
+ * \param storage buffer_count * buffer_sample_count * format->sample_stride bytes, word aligned
+ * \param buffer_count Number of buffers
+ * \param buffer_sample_count Number of samples per buffer
+ */
+void audio_init_static_pool(audio_buffer_pool_t *pool, bool consumer, audio_buffer_format_t *format,
+                            audio_buffer_t *buffers, mem_buffer_t *mem_buffers, uint8_t *storage,
+                            int buffer_count, int buffer_sample_count);
+
 /*! \brief Allocate and initialise an audio wrapping buffer
  *  \ingroup pico_audio
  *
@@ -191,6 +359,9 @@ static inline void release_audio_buffer(audio_buffer_pool_t *ac, audio_buffer_t
  *
  * todo we are currently limited to 4095+1 input samples
  * step is fraction of an input sample per output sample * 0x1000 and should be < 0x1000 i.e. we we are up-sampling (otherwise results are undefined)
+ *
+ * The RP2040 version uses (and reconfigures) interp0 of the calling core; the RP2350 Arm (Cortex-M33) and
+ * RISC-V (Hazard3) versions use plain arithmetic. All implement the arithmetic of the C reference in audio_utils_ref.c.
  */
 void audio_upsample(int16_t *input, int16_t *output, uint output_count, uint32_t step);
 
@@ -207,6 +378,65 @@ void audio_upsample_words(int16_t *input, int16_t *output_aligned, uint output_w
  */
 void audio_upsample_double(int16_t *input, int16_t *output, uint output_count, uint32_t step);
 
+/*! \brief Convert a float sample to S32, saturating
+ *  \ingroup pico_audio
+ *
+ * Full scale is [-1.0, 1.0); values outside it clip to INT32_MIN / INT32_MAX,
+ * fractions are truncated towards zero and NaN becomes 0. With a single precision
+ * FPU (RP2350 Arm) this is one VCVT to fixed point, which scales and saturates in hardware.
+ */
+static inline int32_t audio_f32_to_s32(float sample) {
+#if defined(__ARM_FP) && (__ARM_FP & 4)
+    int32_t result;
+    __asm__ ("vcvt.s32.f32 %1, %1, #31\n\tvmov %0, %1" : "=r" (result), "+t" (sample));
+    return result;
+#else
+    if (sample >= 1.0f) return INT32_MAX;
+    if (sample <= -1.0f) return INT32_MIN;
+    if (sample != sample) return 0;
+    return (int32_t) (sample * 2147483648.0f);
+#endif
+}
+
+/*! \brief Convert a float sample to S24 (right aligned in 32 bits), saturating
+ *  \ingroup pico_audio
+ */
+static inline int32_t audio_f32_to_s24(float sample) {
+    return audio_f32_to_s32(sample) >> 8;
+}
+
+/*! \brief Convert a float sample to S16, saturating
+ *  \ingroup pico_audio
+ */
+static inline int16_t audio_f32_to_s16(float sample) {
+#if defined(__ARM_FP) && (__ARM_FP & 4)
+    int32_t result;
+    __asm__ ("vcvt.s16.f32 %1, %1, #15\n\tvmov %0, %1" : "=r" (result), "+t" (sample));
+    return (int16_t) result;
+#else
+    return (int16_t) (audio_f32_to_s32(sample) >> 16);
+#endif
+}
+
+/*! \brief Convert a block of float samples to S32, saturating
+ *  \ingroup pico_audio
+ *
+ * \param dest destination samples
+ * \param src source samples (may be the same buffer as dest)
+ * \param sample_count number of samples (not frames)
+ */
+void audio_convert_f32_to_s32(int32_t *dest, const float *src, uint sample_count);
+
+/*! \brief Convert a block of float samples to S24 (right aligned in 32 bits), saturating
+ *  \ingroup pico_audio
+ */
+void audio_convert_f32_to_s24(int32_t *dest, const float *src, uint sample_count);
+
+/*! \brief Convert a block of float samples to S16, saturating
+ *  \ingroup pico_audio
+ */
+void audio_convert_f32_to_s16(int16_t *dest, const float *src, uint sample_count);
+
 /*! \brief \todo
  *  \ingroup pico_audio
  */
@@ -268,10 +498,19 @@ struct buffer_copying_on_consumer_take_connection {
     uint32_t current_producer_buffer_pos;
 };
 
+/** \brief When a blocking give connection queues a partially filled consumer buffer
+ */
+typedef enum {
+    AUDIO_FLUSH_WHEN_FULL = 0,  ///< only queue consumer buffers once they are full (default)
+    AUDIO_FLUSH_EACH_GIVE,      ///< queue whatever has been copied at the end of every give
+} audio_flush_policy_t;
+
 struct producer_pool_blocking_give_connection {
     audio_connection_t core;
     audio_buffer_t *current_consumer_buffer;
     uint32_t current_consumer_buffer_pos;
+    audio_flush_policy_t flush_policy;
+    volatile bool flush_requested;      // one-shot AUDIO_FLUSH_EACH_GIVE for the next give
 };
 
 /*! \brief \todo
@@ -314,6 +553,61 @@ void stereo_s16_to_stereo_s16_producer_give(audio_connection_t *connection, audi
  */
 void stereo_s32_to_stereo_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer);
 
+/*! \brief Consumer take converting stereo F32 to stereo S32
+ *  \ingroup pico_audio
+ */
+audio_buffer_t *stereo_f32_to_stereo_s32_consumer_take(audio_connection_t *connection, bool block);
+
+/*! \brief Consumer take converting stereo F32 to stereo S16
+ *  \ingroup pico_audio
+ */
+audio_buffer_t *stereo_f32_to_stereo_s16_consumer_take(audio_connection_t *connection, bool block);
+
+/*! \brief Producer give converting stereo F32 to stereo S32
+ *  \ingroup pico_audio
+ */
+void stereo_f32_to_stereo_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer);
+
+/*! \brief Producer give converting stereo F32 to stereo S16
+ *  \ingroup pico_audio
+ */
+void stereo_f32_to_stereo_s16_producer_give(audio_connection_t *connection, audio_buffer_t *buffer);
+
+/*! \brief Consumer take transposing 2 stereo pairs (4 channels) to I2S bit planes for 2 data lines
+ *  \ingroup pico_audio
+ *
+ * The consumer buffer holds the words for one `out pins, 2` I2S program; see
+ * I2SLinesFmt in pico/sample_conversion.h. The lines4 variants do the same for
+ * 4 stereo pairs on 4 data lines.
+ */
+audio_buffer_t *i2s_lines2_s16_consumer_take(audio_connection_t *connection, bool block);
+audio_buffer_t *i2s_lines4_s16_consumer_take(audio_connection_t *connection, bool block);
+audio_buffer_t *i2s_lines2_s32_consumer_take(audio_connection_t *connection, bool block);
+audio_buffer_t *i2s_lines4_s32_consumer_take(audio_connection_t *connection, bool block);
+
+/*! \brief Producer give transposing stereo pairs to I2S bit planes, see i2s_lines2_s16_consumer_take()
+ *  \ingroup pico_audio
+ */
+void i2s_lines2_s16_producer_give(audio_connection_t *connection, audio_buffer_t *buffer);
+void i2s_lines4_s16_producer_give(audio_connection_t *connection, audio_buffer_t *buffer);
+void i2s_lines2_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer);
+void i2s_lines4_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer);
+
+/*! \brief Consumer take handing the producer's buffers over unchanged
+ *  \ingroup pico_audio
+ *
+ * For a connection whose producer format already matches the consumer (output)
+ * format: the consumer gets the producer's buffer itself, with no copy, and
+ * passthru_consumer_give() returns it to the producer's free list. Segmented
+ * buffers stay segmented.
+ */
+audio_buffer_t *passthru_consumer_take(audio_connection_t *connection, bool block);
+
+/*! \brief Consumer give returning a passed through buffer to the producer pool
+ *  \ingroup pico_audio
+ */
+void passthru_consumer_give(audio_connection_t *connection, audio_buffer_t *buffer);
+
 // not worth a separate header for now
 typedef struct __packed pio_audio_channel_config {
     uint8_t base_pin;
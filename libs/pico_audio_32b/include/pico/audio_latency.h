@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_AUDIO_LATENCY_H
+#define _PICO_AUDIO_LATENCY_H
+
+#include "pico/audio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file audio_latency.h
+ *  \defgroup pico_audio_latency pico_audio_latency
+ *
+ * Producer to pin latency probe
+ *
+ * A probe follows one buffer through the pipeline:
+ *
+ * 1. take_audio_buffer() on a producer pool records the start time
+ * 2. give_audio_buffer() of that buffer overwrites its first two frames with a
+ *    marker (full scale negative, then full scale positive, on every channel)
+ * 3. the output driver scans outgoing buffers for the marker with
+ *    audio_latency_check_buffer() and notes its frame offset
+ * 4. when the driver starts playing that buffer (the next DMA IRQ) the marker
+ *    reaches the PIO FIFO after offset / sample_freq; the latency is recorded
+ *
+ * Only one probe is in flight at a time; audio_latency_probe_start() queues a
+ * number of them back to back. Each probe is an audible click, so mute the
+ * output while measuring. The probe assumes a single producing core.
+ *
+ * When PICO_AUDIO_LATENCY is 0 (the default) the pool hooks compile away.
+ */
+
+// PICO_CONFIG: PICO_AUDIO_LATENCY, Enable the producer to pin latency probe, type=bool, default=0, group=audio
+#ifndef PICO_AUDIO_LATENCY
+#define PICO_AUDIO_LATENCY 0
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_LATENCY_HISTOGRAM_BINS, Number of latency histogram bins (the last one collects overflow), min=2, default=40, group=audio
+#ifndef PICO_AUDIO_LATENCY_HISTOGRAM_BINS
+#define PICO_AUDIO_LATENCY_HISTOGRAM_BINS 40
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_LATENCY_BIN_US, Width of one latency histogram bin in microseconds, min=1, default=1000, group=audio
+#ifndef PICO_AUDIO_LATENCY_BIN_US
+#define PICO_AUDIO_LATENCY_BIN_US 1000
+#endif
+
+typedef struct audio_latency_stats {
+    uint32_t count;                 ///< completed probes
+    uint32_t lost;                  ///< probes whose marker was never seen (buffer dropped or overwritten)
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;              ///< sum of all latencies, for the mean
+    uint32_t histogram[PICO_AUDIO_LATENCY_HISTOGRAM_BINS];
+} audio_latency_stats_t;
+
+/*! \brief Queue latency probes
+ *  \ingroup pico_audio_latency
+ *
+ * \param count number of probes to run back to back
+ */
+void audio_latency_probe_start(uint32_t count);
+
+/*! \brief Clear the collected statistics
+ *  \ingroup pico_audio_latency
+ */
+void audio_latency_reset(void);
+
+/*! \brief Copy the collected statistics
+ *  \ingroup pico_audio_latency
+ */
+void audio_latency_get_stats(audio_latency_stats_t *stats);
+
+/*! \brief Print min/mean/max and the histogram over stdio
+ *  \ingroup pico_audio_latency
+ */
+void audio_latency_print_report(void);
+
+/*! \brief Output driver hook, called for every buffer about to be queued for output
+ *  \ingroup pico_audio_latency
+ *
+ * Must be called from the point where the driver hands the next buffer to the
+ * hardware (the DMA IRQ), once per transfer, including underruns.
+ *
+ * \param buffer buffer being queued, or NULL when silence is played
+ * \param now_us current time (time_us_32())
+ * \return true if the transfer starting now contains the probe marker
+ */
+bool audio_latency_check_buffer(const audio_buffer_t *buffer, uint32_t now_us);
+
+// internal hooks called by take_audio_buffer() / give_audio_buffer()
+extern volatile uint8_t audio_latency_state;
+void audio_latency_on_take(audio_buffer_t *buffer);
+void audio_latency_on_give(audio_buffer_t *buffer);
+
+enum {
+    AUDIO_LATENCY_IDLE = 0,
+    AUDIO_LATENCY_ARMED,            ///< waiting for the producer to take a buffer
+    AUDIO_LATENCY_TAKEN,            ///< producer is filling the probe buffer
+    AUDIO_LATENCY_STAMPED,          ///< marker written, driver is looking for it
+    AUDIO_LATENCY_QUEUED,           ///< marker found, waiting for its transfer to start
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_PICO_AUDIO_LATENCY_H
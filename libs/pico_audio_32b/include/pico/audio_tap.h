@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_AUDIO_TAP_H
+#define _PICO_AUDIO_TAP_H
+
+#include "pico/audio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file audio_tap.h
+ *  \defgroup pico_audio_tap pico_audio_tap
+ *
+ * Bit exact capture of audio signals inside the firmware
+ *
+ * A tap point is a place in the signal path that hands its blocks to
+ * audio_tap_write() (or audio_tap_buffer() for a whole audio_buffer_t). Only
+ * the selected tap is recorded; every other tap returns after one compare.
+ * The selected tap's blocks are copied, each behind an \ref audio_tap_block_header_t,
+ * into a ring that a reader drains with audio_tap_read():
+ *
+ * - the reader side is lock-free (it only moves the read index)
+ * - writers are serialised by a spin lock held for one block copy, so taps may
+ *   be written from either core and from IRQs
+ * - a block that does not fit is dropped whole and counted; the sequence
+ *   number in the next header shows the gap, so the stream never desyncs
+ * - audio_tap_select() discards what is still in the ring and bumps the
+ *   generation stamped into every header, so a reader can tell the blocks of
+ *   its selection from anything it had already taken out before
+ *
+ * The output driver taps what it sends to the PIO as \ref AUDIO_TAP_I2S_OUTPUT;
+ * ids from \ref AUDIO_TAP_USER up are free for application nodes.
+ *
+ * With the pico_audio_tap_usb library the ring is streamed over a USB vendor
+ * class bulk IN endpoint (audio_tap_usb_init()); tools/tap_to_wav.py selects a
+ * tap and writes the capture to a WAV file. That USB device replaces stdio over
+ * USB, so use UART stdio alongside it.
+ *
+ * When PICO_AUDIO_TAP is 0 (the default) every tap call compiles away.
+ */
+
+// PICO_CONFIG: PICO_AUDIO_TAP, Enable audio tap points, type=bool, default=0, group=audio
+#ifndef PICO_AUDIO_TAP
+#define PICO_AUDIO_TAP 0
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_TAP_RING_SIZE, Size of the tap ring in bytes (must be a power of 2), min=1024, default=16384, group=audio
+#ifndef PICO_AUDIO_TAP_RING_SIZE
+#define PICO_AUDIO_TAP_RING_SIZE 16384
+#endif
+
+#if PICO_AUDIO_TAP_RING_SIZE & (PICO_AUDIO_TAP_RING_SIZE - 1)
+#error PICO_AUDIO_TAP_RING_SIZE must be a power of 2
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_TAP_USB_VID, USB vendor id of the tap device, type=int, default=0x2e8a, group=audio
+#ifndef PICO_AUDIO_TAP_USB_VID
+#define PICO_AUDIO_TAP_USB_VID 0x2e8a
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_TAP_USB_PID, USB product id of the tap device, type=int, default=0xfedc, group=audio
+#ifndef PICO_AUDIO_TAP_USB_PID
+#define PICO_AUDIO_TAP_USB_PID 0xfedc
+#endif
+
+#define AUDIO_TAP_MAGIC 0x5441u       ///< "TA" little endian, first field of every block header
+#define AUDIO_TAP_NONE 0xffu          ///< selection value that records nothing
+
+/** \brief Vendor control request (host to interface) selecting the tap to record, wValue = tap id */
+#define AUDIO_TAP_USB_REQUEST_SELECT 0x01u
+/** \brief Vendor control request (interface to host) returning the 1 byte generation of the current selection */
+#define AUDIO_TAP_USB_REQUEST_GET_GENERATION 0x02u
+
+enum audio_tap_id {
+    AUDIO_TAP_I2S_OUTPUT = 0,       ///< buffers as handed to the I2S DMA (single data line only)
+    AUDIO_TAP_USER = 16,            ///< first id available for application taps
+};
+
+/** \brief Header in front of every block in the ring (and the USB stream); 16 bytes, little endian */
+typedef struct audio_tap_block_header {
+    uint16_t magic;                 ///< AUDIO_TAP_MAGIC
+    uint8_t tap;                    ///< tap id
+    uint8_t pcm_format;             ///< \ref audio_pcm_format_t of the samples
+    uint8_t channel_count;
+    uint8_t generation;             ///< audio_tap_get_generation() when the block was written
+    uint16_t frame_count;           ///< frames that follow the header
+    uint32_t sample_freq;
+    uint32_t sequence;              ///< blocks offered by the tap since it was selected (gaps = dropped blocks)
+} audio_tap_block_header_t;
+
+extern volatile uint8_t audio_tap_selected;
+
+/*! \brief Initialise the tap ring (called by audio_tap_usb_init())
+ *  \ingroup pico_audio_tap
+ */
+void audio_tap_init(void);
+
+/*! \brief Select the tap to record and empty the ring
+ *  \ingroup pico_audio_tap
+ *
+ * Restarts the sequence numbers and increments the generation. Blocks still in
+ * the ring are discarded by the reader, after it has finished handing out the
+ * block it is in the middle of (if any). Those bytes, and any the reader had
+ * already taken out (e.g. a USB chunk in flight), still arrive, with the
+ * previous generation in their headers.
+ *
+ * \param tap tap id, or AUDIO_TAP_NONE to stop recording
+ */
+void audio_tap_select(uint tap);
+
+/*! \brief Generation of the current selection (incremented by audio_tap_select(), wraps at 256)
+ *  \ingroup pico_audio_tap
+ */
+uint8_t audio_tap_get_generation(void);
+
+/*! \brief Copy a block into the ring (private, use audio_tap_write())
+ *  \ingroup pico_audio_tap
+ */
+void audio_tap_write_block(uint tap, const audio_format_t *format, const void *frames, uint frame_count);
+
+/*! \brief Record a block of interleaved frames if the tap is selected
+ *  \ingroup pico_audio_tap
+ *
+ * \param tap tap id
+ * \param format format of the frames (pcm format, channel count and sample rate go into the header)
+ * \param frames interleaved frames
+ * \param frame_count number of frames
+ */
+static inline void audio_tap_write(uint tap, const audio_format_t *format, const void *frames, uint frame_count) {
+#if PICO_AUDIO_TAP
+    if (audio_tap_selected == tap) audio_tap_write_block(tap, format, frames, frame_count);
+#else
+    (void) tap;
+    (void) format;
+    (void) frames;
+    (void) frame_count;
+#endif
+}
+
+/*! \brief Record the valid frames of a buffer if the tap is selected
+ *  \ingroup pico_audio_tap
+ */
+static inline void audio_tap_buffer(uint tap, const audio_buffer_t *buffer) {
+    audio_tap_write(tap, buffer->format->format, buffer->buffer->bytes, buffer->sample_count);
+}
+
+/*! \brief Move up to max_bytes of the stream out of the ring
+ *  \ingroup pico_audio_tap
+ *
+ * Called by a single reader. Blocks come out whole and in order, but a read
+ * may end in the middle of one; the next read continues from there (a select
+ * in between takes effect at the end of that block).
+ *
+ * \return number of bytes copied
+ */
+uint audio_tap_read(uint8_t *dst, uint max_bytes);
+
+/*! \brief Bytes waiting in the ring
+ *  \ingroup pico_audio_tap
+ *
+ * Exact as long as no audio_tap_select() runs between this and the following
+ * audio_tap_read() (the USB device selects and reads in its own IRQ). Does not
+ * move the reader, so it may also be called outside the reader's context.
+ */
+uint audio_tap_available(void);
+
+/*! \brief Blocks dropped because the ring was full
+ *  \ingroup pico_audio_tap
+ */
+uint32_t audio_tap_get_dropped(void);
+
+/*! \brief Start the USB vendor device that streams the ring (pico_audio_tap_usb)
+ *  \ingroup pico_audio_tap
+ *
+ * The device has one vendor class interface with a bulk IN endpoint; the host
+ * selects a tap with the \ref AUDIO_TAP_USB_REQUEST_SELECT control request,
+ * asks for its generation with \ref AUDIO_TAP_USB_REQUEST_GET_GENERATION and
+ * reads the block stream from the endpoint, keeping the blocks of that tap
+ * and generation.
+ */
+void audio_tap_usb_init(void);
+
+/*! \brief Resume a USB transfer that ran out of data (pico_audio_tap_usb)
+ *  \ingroup pico_audio_tap
+ *
+ * Call regularly from the thread that called audio_tap_usb_init(); the USB IRQ
+ * refills the endpoint itself as long as the ring has data.
+ */
+void audio_tap_usb_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_PICO_AUDIO_TAP_H
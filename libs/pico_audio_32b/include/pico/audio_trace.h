@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_AUDIO_TRACE_H
+#define _PICO_AUDIO_TRACE_H
+
+#include "pico.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file audio_trace.h
+ *  \defgroup pico_audio_trace pico_audio_trace
+ *
+ * Low-overhead event tracer for the audio pipeline
+ *
+ * Each core owns a ring of timestamped records, so recording an event never
+ * contends with the other core. Interrupts are masked for the few instructions
+ * needed to claim a slot and fill it, so thread and IRQ context on the same core
+ * can both record safely and records stay in timestamp order.
+ *
+ * When PICO_AUDIO_TRACE is 0 (the default) every call compiles away.
+ *
+ * Use audio_trace_dump() to print the rings over stdio and tools/trace_to_chrome.py
+ * on the host to convert the dump into Chrome trace JSON (chrome://tracing, Perfetto).
+ */
+
+// PICO_CONFIG: PICO_AUDIO_TRACE, Enable the audio event tracer, type=bool, default=0, group=audio
+#ifndef PICO_AUDIO_TRACE
+#define PICO_AUDIO_TRACE 0
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_TRACE_BUFFER_SIZE, Number of trace records kept per core (must be a power of 2), min=16, default=1024, group=audio
+#ifndef PICO_AUDIO_TRACE_BUFFER_SIZE
+#define PICO_AUDIO_TRACE_BUFFER_SIZE 1024
+#endif
+
+#if PICO_AUDIO_TRACE_BUFFER_SIZE & (PICO_AUDIO_TRACE_BUFFER_SIZE - 1)
+#error PICO_AUDIO_TRACE_BUFFER_SIZE must be a power of 2
+#endif
+
+typedef enum {
+    AUDIO_TRACE_DMA_IRQ_ENTER = 0, ///< audio DMA IRQ handler entered (arg = DMA channel)
+    AUDIO_TRACE_DMA_IRQ_EXIT,      ///< audio DMA IRQ handler returning (arg = DMA channel)
+    AUDIO_TRACE_BUFFER_TAKE,       ///< take_audio_buffer() returned a buffer (arg = pool type)
+    AUDIO_TRACE_BUFFER_GIVE,       ///< give_audio_buffer() called (arg = pool type)
+    AUDIO_TRACE_RENDER_START,      ///< application render of one block started (arg = user defined)
+    AUDIO_TRACE_RENDER_STOP,       ///< application render of one block finished (arg = user defined)
+    AUDIO_TRACE_UNDERRUN,          ///< DMA had no buffer and played silence (arg = DMA channel)
+    AUDIO_TRACE_USER,              ///< first id available for application events
+} audio_trace_event_t;
+
+typedef struct audio_trace_record {
+    uint32_t timestamp;     ///< time_us_32() at the time of the event
+    uint16_t event;         ///< \ref audio_trace_event_t
+    uint16_t arg;           ///< event specific argument
+} audio_trace_record_t;
+
+typedef struct audio_trace_ring {
+    audio_trace_record_t records[PICO_AUDIO_TRACE_BUFFER_SIZE];
+    uint32_t head;          ///< total number of records written (wraps)
+} audio_trace_ring_t;
+
+extern audio_trace_ring_t audio_trace_rings[NUM_CORES];
+extern volatile bool audio_trace_enabled;
+
+/*! \brief Record an event in the calling core's trace ring
+ *  \ingroup pico_audio_trace
+ *
+ * \param event event id (\ref audio_trace_event_t or >= AUDIO_TRACE_USER)
+ * \param arg event specific argument
+ */
+static __force_inline void audio_trace(uint event, uint arg) {
+#if PICO_AUDIO_TRACE
+    if (!audio_trace_enabled) return;
+    audio_trace_ring_t *ring = &audio_trace_rings[get_core_num()];
+    // timestamp inside the critical section too, so slot order is time order on each core
+    uint32_t save = save_and_disable_interrupts();
+    audio_trace_record_t *record = &ring->records[ring->head++ & (PICO_AUDIO_TRACE_BUFFER_SIZE - 1)];
+    record->timestamp = time_us_32();
+    record->event = (uint16_t) event;
+    record->arg = (uint16_t) arg;
+    restore_interrupts(save);
+#else
+    (void) event;
+    (void) arg;
+#endif
+}
+
+/*! \brief Start or stop recording events
+ *  \ingroup pico_audio_trace
+ *
+ * Recording is enabled at boot when PICO_AUDIO_TRACE is 1.
+ */
+void audio_trace_set_enabled(bool enabled);
+
+/*! \brief Discard all recorded events on both cores
+ *  \ingroup pico_audio_trace
+ */
+void audio_trace_reset(void);
+
+/*! \brief Print the recorded events of both cores over stdio
+ *  \ingroup pico_audio_trace
+ *
+ * Recording is paused while dumping and restored afterwards. The output is a
+ * CSV block delimited by "# audio_trace begin" / "# audio_trace end" lines which
+ * tools/trace_to_chrome.py converts to Chrome trace JSON.
+ */
+void audio_trace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_PICO_AUDIO_TRACE_H
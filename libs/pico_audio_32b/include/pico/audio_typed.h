@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_AUDIO_TYPED_H
+#define _PICO_AUDIO_TYPED_H
+
+/** \file audio_typed.h
+ *  \defgroup pico_audio_typed pico_audio_typed
+ *
+ * Typed C++ view of audio pools and buffers (header only)
+ *
+ * AudioPool<Fmt> and AudioBuffer<Fmt> wrap audio_buffer_pool_t / audio_buffer_t
+ * with the sample format as a type (the Fmt types of sample_conversion.h):
+ *
+ * \code
+ * AudioPool<Stereo<FmtF32>> pool = AudioPool<Stereo<FmtF32>>::producer(48000, 3, 64);
+ * {
+ *     AudioBuffer<Stereo<FmtF32>> buffer = pool.take();
+ *     for (auto &frame : buffer.frames()) {
+ *         frame[0] = left;
+ *         frame[1] = right;
+ *     }
+ *     buffer.give();  // or let it go out of scope to hand it back unused
+ * }
+ * \endcode
+ *
+ * A pool allocated through AudioPool gets its format (pcm format, channel
+ * count, sample stride) from Fmt, so it matches by construction. An existing
+ * pool wrapped with AudioPool(audio_buffer_pool_t *) is only checked at run
+ * time, with asserts: pcm format and channel count once when it is wrapped,
+ * and the sample stride of each buffer when it is taken (the stride lives in
+ * the buffers, not the pool). Either way frame access needs no casts and
+ * compiles to the same pointer arithmetic as hand written `samples[i * 2 + c]`
+ * indexing.
+ *
+ * A buffer that is not given explicitly is handed back when it goes out of
+ * scope: a producer buffer is returned unplayed to the free list, a consumer
+ * buffer is released as read.
+ */
+
+#include "pico/sample_conversion.h"
+
+#ifdef __cplusplus
+
+/** \brief AUDIO_PCM_FORMAT_xxx of a sample format type */
+template<typename Fmt>
+struct audio_pcm_format_of;
+
+template<> struct audio_pcm_format_of<FmtS8>  { static constexpr audio_pcm_format_t value = AUDIO_PCM_FORMAT_S8; };
+template<> struct audio_pcm_format_of<FmtU8>  { static constexpr audio_pcm_format_t value = AUDIO_PCM_FORMAT_U8; };
+template<> struct audio_pcm_format_of<FmtS16> { static constexpr audio_pcm_format_t value = AUDIO_PCM_FORMAT_S16; };
+template<> struct audio_pcm_format_of<FmtU16> { static constexpr audio_pcm_format_t value = AUDIO_PCM_FORMAT_U16; };
+template<> struct audio_pcm_format_of<FmtS32> { static constexpr audio_pcm_format_t value = AUDIO_PCM_FORMAT_S32; };
+template<> struct audio_pcm_format_of<FmtU32> { static constexpr audio_pcm_format_t value = AUDIO_PCM_FORMAT_U32; };
+template<> struct audio_pcm_format_of<FmtF32> { static constexpr audio_pcm_format_t value = AUDIO_PCM_FORMAT_F32; };
+
+template<typename Fmt, uint ChannelCount>
+struct audio_pcm_format_of<MultiChannelFmt<Fmt, ChannelCount>> : audio_pcm_format_of<Fmt> {};
+
+/** \brief Contiguous run of frames; frame i is an array of Fmt::channel_count samples */
+template<typename Fmt>
+class AudioFrameSpan {
+public:
+    typedef typename Fmt::sample_t sample_t;
+    typedef sample_t frame_t[Fmt::channel_count];
+
+    static_assert(sizeof(frame_t) == Fmt::frame_stride, "frames must be packed");
+
+    AudioFrameSpan(frame_t *frames, uint size) : frames_(frames), size_(size) {}
+
+    frame_t &operator[](uint i) const { return frames_[i]; }
+    frame_t *begin() const { return frames_; }
+    frame_t *end() const { return frames_ + size_; }
+    frame_t *data() const { return frames_; }
+    uint size() const { return size_; }
+
+    /** \brief Sub span [offset, offset + count) */
+    AudioFrameSpan subspan(uint offset, uint count) const { return AudioFrameSpan(frames_ + offset, count); }
+
+    /** \brief Samples as one interleaved array of size() * channel_count */
+    sample_t *samples() const { return &frames_[0][0]; }
+
+private:
+    frame_t *frames_;
+    uint size_;
+};
+
+/** \brief Buffer taken from an AudioPool; hands itself back when it goes out of scope */
+template<typename Fmt>
+class AudioBuffer {
+public:
+    AudioBuffer() : pool_(nullptr), buffer_(nullptr) {}
+    AudioBuffer(audio_buffer_pool_t *pool, audio_buffer_t *buffer) : pool_(pool), buffer_(buffer) {}
+    AudioBuffer(AudioBuffer &&other) noexcept : pool_(other.pool_), buffer_(other.buffer_) {
+        other.buffer_ = nullptr;
+    }
+    AudioBuffer &operator=(AudioBuffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            pool_ = other.pool_;
+            buffer_ = other.buffer_;
+            other.buffer_ = nullptr;
+        }
+        return *this;
+    }
+    AudioBuffer(const AudioBuffer &) = delete;
+    AudioBuffer &operator=(const AudioBuffer &) = delete;
+    ~AudioBuffer() { release(); }
+
+    /** \brief false if take() returned nothing (non-blocking take) or the buffer has been given */
+    explicit operator bool() const { return buffer_ != nullptr; }
+
+    /** \brief Whole buffer (max_sample_count frames), for filling */
+    AudioFrameSpan<Fmt> frames() const {
+        return AudioFrameSpan<Fmt>(frame_ptr(), buffer_->max_sample_count);
+    }
+
+    /** \brief Valid frames (sample_count), for reading */
+    AudioFrameSpan<Fmt> valid_frames() const {
+        return AudioFrameSpan<Fmt>(frame_ptr(), buffer_->sample_count);
+    }
+
+    uint capacity() const { return buffer_->max_sample_count; }
+
+    /** \brief Give the buffer back to the pool with all frames valid */
+    void give() { give(buffer_->max_sample_count); }
+
+    /** \brief Give the buffer back to the pool with frame_count frames valid */
+    void give(uint frame_count) {
+        buffer_->sample_count = frame_count;
+        give_audio_buffer(pool_, buffer_);
+        buffer_ = nullptr;
+    }
+
+    /** \brief The underlying C buffer (still owned by this object) */
+    audio_buffer_t *get() const { return buffer_; }
+
+private:
+    typename AudioFrameSpan<Fmt>::frame_t *frame_ptr() const {
+        return reinterpret_cast<typename AudioFrameSpan<Fmt>::frame_t *>(buffer_->buffer->bytes);
+    }
+
+    void release() {
+        if (!buffer_) return;
+        if (pool_->type == audio_buffer_pool::ac_producer) {
+            // never filled: back to the free list without playing it
+            queue_free_audio_buffer(pool_, buffer_);
+        } else {
+            give_audio_buffer(pool_, buffer_);
+        }
+        buffer_ = nullptr;
+    }
+
+    audio_buffer_pool_t *pool_;
+    audio_buffer_t *buffer_;
+};
+
+/** \brief Pool whose buffers hold Fmt frames */
+template<typename Fmt>
+class AudioPool {
+public:
+    static constexpr audio_pcm_format_t pcm_format = audio_pcm_format_of<Fmt>::value;
+    static constexpr uint channel_count = Fmt::channel_count;
+    static constexpr uint frame_stride = Fmt::frame_stride;
+
+    AudioPool() : pool_(nullptr) {}
+
+    /** \brief Wrap an existing pool; its format must be Fmt (asserted here, and the stride on take()) */
+    explicit AudioPool(audio_buffer_pool_t *pool) : pool_(pool) {
+        assert(!pool || (pool->format->pcm_format == pcm_format && pool->format->channel_count == channel_count));
+    }
+
+    /** \brief Allocate a producer pool of Fmt buffers, see audio_new_producer_pool() */
+    static AudioPool producer(uint32_t sample_freq, int buffer_count, int buffer_frames) {
+        return AudioPool(audio_new_producer_pool(new_buffer_format(sample_freq), buffer_count, buffer_frames));
+    }
+
+    /** \brief Allocate a consumer pool of Fmt buffers, see audio_new_consumer_pool() */
+    static AudioPool consumer(uint32_t sample_freq, int buffer_count, int buffer_frames) {
+        return AudioPool(audio_new_consumer_pool(new_buffer_format(sample_freq), buffer_count, buffer_frames));
+    }
+
+    /** \brief Take a buffer (free from a producer pool, full from a consumer pool) */
+    AudioBuffer<Fmt> take(bool block = true) const {
+        audio_buffer_t *buffer = take_audio_buffer(pool_, block);
+        assert(!buffer || buffer->format->sample_stride == frame_stride);
+        return AudioBuffer<Fmt>(pool_, buffer);
+    }
+
+    audio_buffer_pool_t *get() const { return pool_; }
+    explicit operator bool() const { return pool_ != nullptr; }
+
+private:
+    // pools live for the whole program, as do the formats they point at
+    static audio_buffer_format_t *new_buffer_format(uint32_t sample_freq) {
+        audio_format_t *format = new audio_format_t{sample_freq, pcm_format, (audio_channel_t) channel_count};
+        return new audio_buffer_format_t{format, (uint16_t) frame_stride};
+    }
+
+    audio_buffer_pool_t *pool_;
+};
+
+#endif
+#endif //_PICO_AUDIO_TYPED_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_AUDIO_VERIFY_H
+#define _PICO_AUDIO_VERIFY_H
+
+#include "pico/audio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file audio_verify.h
+ *  \defgroup pico_audio_verify pico_audio_verify
+ *
+ * Continuity checker for soak testing the audio path
+ *
+ * The producer plays a known test signal: a phase accumulator ramp where every
+ * channel of frame n holds n * step (wrapping at the sample width). The checker
+ * is fed each buffer as it leaves the consumer stage (the I2S driver does this
+ * when PICO_AUDIO_I2S_VERIFY is 1) and classifies every frame-to-frame step:
+ *
+ * - delta == step           : continuous
+ * - delta == 0              : repeated frame
+ * - delta == k * step       : k - 1 missing frames (k <= max_missing_frames)
+ * - anything else           : discontinuity (corrupted or misaligned data)
+ *
+ * It also counts silence buffers played on underrun and measures the jitter of
+ * buffer start times against the duration of the buffers actually played.
+ */
+
+// PICO_CONFIG: PICO_AUDIO_VERIFY_EVENT_LOG_SIZE, Number of most recent verify events kept with timestamps, min=1, default=16, group=audio
+#ifndef PICO_AUDIO_VERIFY_EVENT_LOG_SIZE
+#define PICO_AUDIO_VERIFY_EVENT_LOG_SIZE 16
+#endif
+
+typedef enum {
+    AUDIO_VERIFY_DISCONTINUITY = 0, ///< frame delta is not a multiple of the step
+    AUDIO_VERIFY_REPEATED,          ///< frame identical to the previous frame
+    AUDIO_VERIFY_MISSING,           ///< frames skipped (count = number missing)
+    AUDIO_VERIFY_UNDERRUN,          ///< driver played silence instead of a buffer
+    AUDIO_VERIFY_JITTER,            ///< buffer started outside the jitter tolerance (count = error in us)
+} audio_verify_event_kind_t;
+
+typedef struct audio_verify_event {
+    uint32_t timestamp_us;          ///< time_us_32() when the buffer was checked
+    uint32_t frame;                 ///< index of the offending frame in the stream (low 32 bits)
+    uint32_t count;                 ///< kind specific, see \ref audio_verify_event_kind_t
+    uint8_t kind;                   ///< \ref audio_verify_event_kind_t
+} audio_verify_event_t;
+
+typedef struct audio_verify_config {
+    uint32_t step;                  ///< ramp increment per frame, in sample units of the stream format (0 is treated as 1)
+    uint32_t max_missing_frames;    ///< largest gap still classified as missing frames
+    uint32_t jitter_tolerance_us;   ///< allowed deviation of a buffer start time
+} audio_verify_config_t;
+
+typedef struct audio_verify_report {
+    uint64_t frames_checked;
+    uint32_t buffers_checked;
+    uint32_t discontinuities;
+    uint32_t repeated_frames;
+    uint32_t missing_frames;
+    uint32_t underruns;
+    uint32_t jitter_violations;
+    uint32_t max_jitter_us;
+    uint32_t event_count;           ///< total events (the log keeps the last PICO_AUDIO_VERIFY_EVENT_LOG_SIZE)
+    audio_verify_event_t events[PICO_AUDIO_VERIFY_EVENT_LOG_SIZE];
+} audio_verify_report_t;
+
+/*! \brief Reset the checker and start a new run
+ *  \ingroup pico_audio_verify
+ *
+ * \param config test signal and tolerances; copied
+ */
+void audio_verify_start(const audio_verify_config_t *config);
+
+/*! \brief Write frames of the test signal
+ *  \ingroup pico_audio_verify
+ *
+ * For producers that render into memory they do not hold as an audio_buffer_t,
+ * e.g. an I2S render callback. Supports S16 and S32 with any channel count.
+ *
+ * \param samples interleaved output
+ * \param pcm_format AUDIO_PCM_FORMAT_S16 or AUDIO_PCM_FORMAT_S32
+ * \param channel_count channels per frame
+ * \param frame_count frames to write
+ * \param phase ramp position, advanced by the frames written
+ * \param step ramp increment per frame
+ */
+void audio_verify_generate_frames(void *samples, audio_pcm_format_t pcm_format, uint channel_count,
+                                  uint frame_count, uint32_t *phase, uint32_t step);
+
+/*! \brief Fill a buffer with the test signal
+ *  \ingroup pico_audio_verify
+ *
+ * Writes max_sample_count frames of the ramp and sets sample_count.
+ * Supports S16 and S32 buffers with any channel count.
+ *
+ * \param buffer buffer to fill
+ * \param phase ramp position, advanced by the frames written
+ * \param step ramp increment per frame
+ */
+void audio_verify_generate(audio_buffer_t *buffer, uint32_t *phase, uint32_t step);
+
+/*! \brief Check one buffer as it is handed to the output
+ *  \ingroup pico_audio_verify
+ *
+ * Does nothing until audio_verify_start() has been called. The step is taken
+ * modulo the sample width, so an S16 stream needs a step with nonzero low 16
+ * bits; a step that is 0 in the stream's width is treated as 1.
+ *
+ * \param buffer buffer about to be played, or NULL when the output plays silence
+ * \param now_us current time (time_us_32())
+ */
+void audio_verify_check_buffer(const audio_buffer_t *buffer, uint32_t now_us);
+
+/*! \brief Copy the current results
+ *  \ingroup pico_audio_verify
+ */
+void audio_verify_get_report(audio_verify_report_t *report);
+
+/*! \brief true if nothing has been flagged since audio_verify_start()
+ *  \ingroup pico_audio_verify
+ */
+bool audio_verify_passed(void);
+
+/*! \brief Print the counters, the event log and a PASS/FAIL line over stdio
+ *  \ingroup pico_audio_verify
+ */
+void audio_verify_print_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_PICO_AUDIO_VERIFY_H
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
 #include "pico/audio.h"
 #include "pico/util/buffer.h"
 
@@ -40,6 +41,9 @@ typedef struct : public FmtDetails<uint32_t> {
 typedef struct : public FmtDetails<int32_t> {
 } FmtS32;
 
+typedef struct : public FmtDetails<float> {
+} FmtF32;
+
 // Multi channel is just N samples back to back
 template<typename Fmt, uint ChannelCount>
 struct MultiChannelFmt {
@@ -159,6 +163,22 @@ struct sample_converter<FmtU8, FmtS16> {
     }
 };
 
+// saturating converters from F32
+
+template<>
+struct sample_converter<FmtS32, FmtF32> {
+    static int32_t convert_sample(const float &sample) {
+        return audio_f32_to_s32(sample);
+    }
+};
+
+template<>
+struct sample_converter<FmtS16, FmtF32> {
+    static int16_t convert_sample(const float &sample) {
+        return audio_f32_to_s16(sample);
+    }
+};
+
 // template type for doing sample conversion
 template<typename ToFmt, typename FromFmt>
 struct converting_copy {
@@ -186,6 +206,20 @@ struct converting_copy<MultiChannelFmt<ToFmt, NumChannels>, MultiChannelFmt<From
     }
 };
 
+// N channel F32 to N channel S32/S16 use the block converters
+template<uint NumChannels>
+struct converting_copy<MultiChannelFmt<FmtS32, NumChannels>, MultiChannelFmt<FmtF32, NumChannels>> {
+    static void copy(int32_t *dest, const float *src, uint sample_count) {
+        audio_convert_f32_to_s32(dest, src, sample_count * NumChannels);
+    }
+};
+
+template<uint NumChannels>
+struct converting_copy<MultiChannelFmt<FmtS16, NumChannels>, MultiChannelFmt<FmtF32, NumChannels>> {
+    static void copy(int16_t *dest, const float *src, uint sample_count) {
+        audio_convert_f32_to_s16(dest, src, sample_count * NumChannels);
+    }
+};
 
 // mono->stereo conversion
 template<typename ToFmt, typename FromFmt>
@@ -212,6 +246,80 @@ struct converting_copy<Mono<ToFmt>, Stereo<FromFmt>> {
     }
 };
 
+// I2S bit planes for Lines data pins driven by one `out pins, Lines`: each
+// 32 bit word holds Lines bits per BCLK, the bit for pin data_pin + j at bit j
+// of each group. Frames are Lines stereo pairs, pair j played on line j.
+template<typename Fmt, uint Lines>
+struct I2SLinesFmt {
+    static const uint channel_count = 2 * Lines;
+    static const uint frame_stride = channel_count * Fmt::frame_stride;
+    typedef typename Fmt::sample_t sample_t;
+};
+
+// move bit i of the low 16 bits to bit 2i
+static inline uint32_t i2s_spread_bits_2(uint32_t x) {
+    x &= 0xffffu;
+    x = (x | (x << 8)) & 0x00ff00ffu;
+    x = (x | (x << 4)) & 0x0f0f0f0fu;
+    x = (x | (x << 2)) & 0x33333333u;
+    x = (x | (x << 1)) & 0x55555555u;
+    return x;
+}
+
+// move bit i of the low 8 bits to bit 4i
+static inline uint32_t i2s_spread_bits_4(uint32_t x) {
+    x &= 0xffu;
+    x = (x | (x << 12)) & 0x000f000fu;
+    x = (x | (x << 6)) & 0x03030303u;
+    x = (x | (x << 3)) & 0x11111111u;
+    return x;
+}
+
+// word w (MSB first) of one channel slot, from the left aligned samples of each line
+template<uint Lines>
+struct i2s_bit_plane_word;
+
+template<>
+struct i2s_bit_plane_word<2> {
+    static uint32_t get(const uint32_t *v, uint w) {
+        uint shift = 16 - 16 * w;
+        return i2s_spread_bits_2(v[0] >> shift) | (i2s_spread_bits_2(v[1] >> shift) << 1);
+    }
+};
+
+template<>
+struct i2s_bit_plane_word<4> {
+    static uint32_t get(const uint32_t *v, uint w) {
+        uint shift = 24 - 8 * w;
+        return i2s_spread_bits_4(v[0] >> shift) | (i2s_spread_bits_4(v[1] >> shift) << 1) |
+               (i2s_spread_bits_4(v[2] >> shift) << 2) | (i2s_spread_bits_4(v[3] >> shift) << 3);
+    }
+};
+
+template<typename Fmt, uint Lines>
+struct converting_copy<I2SLinesFmt<Fmt, Lines>, MultiChannelFmt<Fmt, 2 * Lines>> {
+    typedef typename Fmt::sample_t sample_t;
+    static const uint bits = 8 * sizeof(sample_t);
+    static const uint words_per_slot = bits * Lines / 32;
+    static_assert(words_per_slot * 32 == bits * Lines, "bit planes must fill whole words");
+
+    static void copy(sample_t *dest, const sample_t *src, uint sample_count) {
+        uint32_t *out = (uint32_t *) dest;
+        for (; sample_count; sample_count--) {
+            for (uint c = 0; c < 2; c++) {
+                uint32_t v[Lines];
+                for (uint j = 0; j < Lines; j++) {
+                    v[j] = (uint32_t) (typename std::make_unsigned<sample_t>::type) src[2 * j + c] << (32 - bits);
+                }
+                for (uint w = 0; w < words_per_slot; w++) {
+                    *out++ = i2s_bit_plane_word<Lines>::get(v, w);
+                }
+            }
+            src += 2 * Lines;
+        }
+    }
+};
+
 template<typename ToFmt, typename FromFmt>
 audio_buffer_t *consumer_pool_take(audio_connection_t *connection, bool block) {
     struct buffer_copying_on_consumer_take_connection *cc = (struct buffer_copying_on_consumer_take_connection *) connection;
@@ -236,12 +344,14 @@ audio_buffer_t *consumer_pool_take(audio_connection_t *connection, bool block) {
             assert(cc->current_producer_buffer->format->sample_stride == FromFmt::frame_stride);
             cc->current_producer_buffer_pos = 0;
         }
-        uint sample_count = std::min(buffer->max_sample_count - pos,
-                                     cc->current_producer_buffer->sample_count - cc->current_producer_buffer_pos);
+        // the producer buffer may be segmented; copy up to the end of the current fragment
+        uint32_t contiguous;
+        const uint8_t *src = audio_buffer_bytes_at(cc->current_producer_buffer, cc->current_producer_buffer_pos,
+                                                   &contiguous);
+        uint sample_count = std::min(buffer->max_sample_count - pos, (uint) contiguous);
         converting_copy<ToFmt, FromFmt>::copy(
                 ((typename ToFmt::sample_t *) buffer->buffer->bytes) + pos * ToFmt::channel_count,
-                ((typename FromFmt::sample_t *) cc->current_producer_buffer->buffer->bytes) +
-                cc->current_producer_buffer_pos * FromFmt::channel_count,
+                (const typename FromFmt::sample_t *) src,
                 sample_count);
         pos += sample_count;
         cc->current_producer_buffer_pos += sample_count;
@@ -264,14 +374,16 @@ void producer_pool_blocking_give(audio_connection_t *connection, audio_buffer_t
             pbc->current_consumer_buffer = get_free_audio_buffer(pbc->core.consumer_pool, true);
             pbc->current_consumer_buffer_pos = 0;
         }
-        uint sample_count = std::min(buffer->sample_count - pos,
+        uint32_t contiguous;
+        const uint8_t *src = audio_buffer_bytes_at(buffer, pos, &contiguous);
+        uint sample_count = std::min((uint) contiguous,
                                      pbc->current_consumer_buffer->max_sample_count - pbc->current_consumer_buffer_pos);
         assert(buffer->format->sample_stride == FromFmt::frame_stride);
         assert(buffer->format->format->channel_count == FromFmt::channel_count);
         converting_copy<ToFmt, FromFmt>::copy(
                 ((typename ToFmt::sample_t *) pbc->current_consumer_buffer->buffer->bytes) +
                 pbc->current_consumer_buffer_pos * ToFmt::channel_count,
-                ((typename FromFmt::sample_t *) buffer->buffer->bytes) + pos * FromFmt::channel_count, sample_count);
+                (const typename FromFmt::sample_t *) src, sample_count);
         pos += sample_count;
         pbc->current_consumer_buffer_pos += sample_count;
         if (pbc->current_consumer_buffer_pos == pbc->current_consumer_buffer->max_sample_count) {
@@ -280,14 +392,21 @@ void producer_pool_blocking_give(audio_connection_t *connection, audio_buffer_t
             pbc->current_consumer_buffer = NULL;
         }
     }
-    // todo this should be a connection configuration (or a seaparate connection type)
+    // optionally commit a partial buffer now rather than waiting for it to fill;
+    // the consumer plays it as a shorter buffer
 #ifdef BLOCKING_GIVE_SYNCHRONIZE_BUFFERS
-    if (pbc->current_consumer_buffer) {
-        pbc->current_consumer_buffer->sample_count = pbc->current_consumer_buffer_pos;
-        queue_full_audio_buffer(pbc->core.consumer_pool, pbc->current_consumer_buffer);
-        pbc->current_consumer_buffer = NULL;
-    }
+    bool flush = true;
+#else
+    bool flush = pbc->flush_policy == AUDIO_FLUSH_EACH_GIVE || pbc->flush_requested;
 #endif
+    if (flush) {
+        pbc->flush_requested = false;
+        if (pbc->current_consumer_buffer) {
+            pbc->current_consumer_buffer->sample_count = pbc->current_consumer_buffer_pos;
+            queue_full_audio_buffer(pbc->core.consumer_pool, pbc->current_consumer_buffer);
+            pbc->current_consumer_buffer = NULL;
+        }
+    }
     assert(pos == buffer->sample_count);
     queue_free_audio_buffer(pbc->core.producer_pool, buffer);
 }
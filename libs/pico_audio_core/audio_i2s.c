@@ -16,7 +16,7 @@
  * data transfer with minimal CPU overhead.
  * 
  * Key Features:
- * - 32-bit PCM audio support up to 192 kHz
+ * - 32-bit PCM audio support up to 768 kHz (clk_sys permitting)
  * - Double-buffered DMA for glitch-free playback  
  * - Dynamic sample rate adjustment
  * - Optional dual-core processing
@@ -43,8 +43,15 @@
 #include "hardware/regs/dreq.h"    // DMA request signals
 
 // Audio I2S Implementation
+#include "pico/hw_resource.h" // Shared PIO program / SM / DMA / IRQ allocation
 #include "audio_i2s.pio.h"     // Generated PIO program header
 #include "pico/audio_i2s.h"    // Public API definitions
+#include "pico/audio_trace.h"  // Event tracing (compiled out unless PICO_AUDIO_TRACE)
+#if PICO_AUDIO_I2S_VERIFY
+#include "pico/audio_verify.h" // Continuity checker for soak tests
+#endif
+#include "pico/audio_latency.h" // Latency probe (compiled out unless PICO_AUDIO_LATENCY)
+#include "pico/audio_tap.h"     // Output tap (compiled out unless PICO_AUDIO_TAP)
 
 // ============================================================================
 // Compilation Configuration
@@ -125,6 +132,16 @@ CU_REGISTER_DEBUG_PINS(audio_timing)
  */
 static uint loaded_offset = 0;
 
+/**
+ * @brief PIO program in use
+ *
+ * audio_i2s_program for a single data line, otherwise multi_line_program:
+ * a copy with `out pins, data_line_count` (see audio_i2s_program_patch_lines()).
+ */
+static const pio_program_t *loaded_program = &audio_i2s_program;
+static pio_program_t multi_line_program;
+static uint16_t multi_line_instructions[count_of(audio_i2s_program_instructions)];
+
 /**
  * @brief Input audio format specification
  * 
@@ -150,10 +167,15 @@ static const audio_format_t *_i2s_output_audio_format;
 struct {
     audio_buffer_t *playing_buffer0;  /**< Currently playing buffer on DMA channel 0 */
     audio_buffer_t *playing_buffer1;  /**< Currently playing buffer on DMA channel 1 */
+    audio_buffer_t *segmented_buffer; /**< Segmented buffer with fragments still to queue, or NULL */
+    uint32_t next_segment;            /**< Next fragment of segmented_buffer to queue */
+    bool passthru;                    /**< Consumer buffers belong to the producer (audio_i2s_connect_passthru()) */
     uint32_t freq;                    /**< Current sampling frequency in Hz */
     uint8_t pio_sm;                   /**< PIO state machine number (0-3) */
     uint8_t dma_channel0;             /**< First DMA channel for ping-pong buffering */
     uint8_t dma_channel1;             /**< Second DMA channel for ping-pong buffering */
+    uint8_t data_line_count;          /**< SDATA pins driven by the state machine (1, 2 or 4) */
+    bool enabled;                     /**< Between audio_i2s_set_enabled(true) and (false): transfers armed or running */
 } shared_state;
 
 /**
@@ -207,6 +229,54 @@ static audio_buffer_pool_t *audio_i2s_consumer;
  */
 static audio_buffer_t silence_buffer;
 
+/**
+ * @brief Render callback state (pull mode)
+ *
+ * When a render callback is set, each DMA channel plays its own driver-owned
+ * buffer, refilled by the callback as soon as that channel finishes. The
+ * buffers are wrapped as audio_buffer_t so the rest of the transfer path
+ * (verification, silence handling) is shared with the pool mode.
+ */
+static struct {
+    audio_i2s_render_callback_t callback; /**< NULL when a producer pool is connected */
+    void *ctx;                            /**< User context for the callback */
+    uint64_t frame_pos;                   /**< Stream position of the next rendered frame */
+    audio_buffer_t buffers[2];            /**< One buffer per DMA channel */
+} render_state;
+
+/**
+ * @brief DMA IRQ core affinity
+ *
+ * The DMA IRQ handler is installed in the NVIC of the core that calls
+ * audio_i2s_attach_irq(); audio_i2s_set_enabled() does so itself unless a
+ * different core was chosen with audio_i2s_set_irq_core().
+ */
+static struct {
+    int8_t core;                /**< Core to take the DMA IRQ, -1 for the enabling core */
+    int8_t attached_core;       /**< Core the handler is currently installed on, -1 if none */
+    volatile bool start_pending; /**< Transfers armed, waiting for audio_i2s_attach_irq() */
+} irq_affinity = {
+    .core = -1,
+    .attached_core = -1,
+};
+
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+/**
+ * @brief Deferred callback state
+ *
+ * The DMA IRQ only records what needs doing and pends the claimed user IRQ;
+ * the work itself runs in audio_i2s_callback_irq_handler() at
+ * PICO_AUDIO_I2S_CALLBACK_IRQ_PRIORITY.
+ */
+static struct {
+    int irq;                         /**< Claimed user IRQ number, -1 when not claimed */
+    volatile uint8_t render_pending; /**< Bit n set: render buffer n before its channel plays again */
+    volatile uint8_t callbacks;      /**< Number of i2s_callback_func() calls owed */
+} deferred_state = {
+    .irq = -1,
+};
+#endif
+
 // ============================================================================
 // Forward Declarations
 // ============================================================================
@@ -222,6 +292,24 @@ static audio_buffer_t silence_buffer;
  */
 static void __isr __time_critical_func(audio_i2s_dma_irq_handler)(void);
 
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+/**
+ * @brief Software IRQ handler running the render and user callbacks
+ *
+ * Pended by the DMA IRQ after it has re-armed the next transfer; runs at
+ * PICO_AUDIO_I2S_CALLBACK_IRQ_PRIORITY so it never delays DMA servicing.
+ */
+static void __isr __time_critical_func(audio_i2s_callback_irq_handler)(void);
+#endif
+
+/**
+ * @brief Set the consumer (DMA side) format to the output format at a given rate
+ *
+ * Used by every connect variant, including audio_i2s_connect_passthru() which
+ * is defined above it.
+ */
+static void configure_consumer_format(uint32_t sample_freq);
+
 // ============================================================================
 // Debug and Timing Utilities
 // ============================================================================
@@ -271,9 +359,10 @@ static inline uint32_t _micros(void)
  * with their own implementation. If not overridden, this empty default
  * implementation is used.
  * 
- * @note This function is called from interrupt context (or Core1 if
- *       CORE1_PROCESS_I2S_CALLBACK is enabled). Keep processing minimal
- *       and avoid blocking operations.
+ * @note This function is called from interrupt context: the low-priority
+ *       deferred callback IRQ when PICO_AUDIO_I2S_DEFER_CALLBACK is 1 (the
+ *       default), otherwise the DMA IRQ itself (or Core1 if
+ *       CORE1_PROCESS_I2S_CALLBACK is enabled). Avoid blocking operations.
  * 
  * @note Timing constraints: This function should complete within the
  *       duration of one audio buffer to avoid audio dropouts.
@@ -359,33 +448,54 @@ void audio_i2s_end(void)
 {
     audio_buffer_t *ab;
     
-    // Release all queued audio buffers from the consumer pool
-    // These are buffers waiting to be played
-    ab = take_audio_buffer(audio_i2s_consumer, false);
-    while (ab != NULL) {
-        free(ab->buffer->bytes);  // Free audio data
-        free(ab->buffer);         // Free buffer wrapper
+    // Release render mode buffers (no consumer pool exists in render mode)
+    audio_i2s_set_render_callback(NULL, NULL, 0);
+
+    if (shared_state.passthru) {
+        // the buffers belong to the producer pool; just hand back the ones we hold
+        if (shared_state.playing_buffer0) queue_free_audio_buffer(audio_i2s_consumer->connection->producer_pool,
+                                                                  shared_state.playing_buffer0);
+        if (shared_state.playing_buffer1) queue_free_audio_buffer(audio_i2s_consumer->connection->producer_pool,
+                                                                  shared_state.playing_buffer1);
+        if (shared_state.segmented_buffer) {
+            // part played; never one of the playing buffers (only the last fragment's channel holds it)
+            queue_free_audio_buffer(audio_i2s_consumer->connection->producer_pool, shared_state.segmented_buffer);
+        }
+        shared_state.playing_buffer0 = NULL;
+        shared_state.playing_buffer1 = NULL;
+        shared_state.passthru = false;
+    } else if (audio_i2s_consumer) {
+        // Release all queued audio buffers from the consumer pool
+        // These are buffers waiting to be played
         ab = take_audio_buffer(audio_i2s_consumer, false);
-    }
-    
-    // Release all free buffers from the pool
-    // These are unused buffers ready for allocation
-    ab = get_free_audio_buffer(audio_i2s_consumer, false);
-    while (ab != NULL) {
-        free(ab->buffer->bytes);  // Free audio data
-        free(ab->buffer);         // Free buffer wrapper
+        while (ab != NULL) {
+            free(ab->buffer->bytes);  // Free audio data
+            free(ab->buffer);         // Free buffer wrapper
+            ab = take_audio_buffer(audio_i2s_consumer, false);
+        }
+
+        // Release all free buffers from the pool
+        // These are unused buffers ready for allocation
         ab = get_free_audio_buffer(audio_i2s_consumer, false);
-    }
-    
-    // Release all full buffers from the pool
-    // These are buffers filled with audio data but not yet queued
-    ab = get_full_audio_buffer(audio_i2s_consumer, false);
-    while (ab != NULL) {
-        free(ab->buffer->bytes);  // Free audio data
-        free(ab->buffer);         // Free buffer wrapper
+        while (ab != NULL) {
+            free(ab->buffer->bytes);  // Free audio data
+            free(ab->buffer);         // Free buffer wrapper
+            ab = get_free_audio_buffer(audio_i2s_consumer, false);
+        }
+
+        // Release all full buffers from the pool
+        // These are buffers filled with audio data but not yet queued
         ab = get_full_audio_buffer(audio_i2s_consumer, false);
+        while (ab != NULL) {
+            free(ab->buffer->bytes);  // Free audio data
+            free(ab->buffer);         // Free buffer wrapper
+            ab = get_full_audio_buffer(audio_i2s_consumer, false);
+        }
     }
     
+    shared_state.segmented_buffer = NULL;
+    shared_state.next_segment = 0;
+
     // Release currently playing buffers
     // These buffers are actively being transferred by DMA
     if (shared_state.playing_buffer0 != NULL) {
@@ -402,6 +512,7 @@ void audio_i2s_end(void)
     
     // Release buffer pool structure
     free(audio_i2s_consumer);
+    audio_i2s_consumer = NULL;
     
     // Release silence buffer used for underrun protection
     free(silence_buffer.buffer->bytes);
@@ -411,9 +522,10 @@ void audio_i2s_end(void)
     uint8_t sm = shared_state.pio_sm;
     pio_sm_clear_fifos(audio_pio, sm);           // Clear any remaining data
     pio_sm_drain_tx_fifo(audio_pio, sm);        // Ensure TX FIFO is empty
-    pio_remove_program(audio_pio, &audio_i2s_program, loaded_offset);  // Unload program
-    pio_clear_instruction_memory(audio_pio);    // Clear program memory
+    hw_resource_remove_pio_program(audio_pio, loaded_program);  // Unload program (if no other user)
     pio_sm_unclaim(audio_pio, sm);              // Release state machine
+    dma_channel_unclaim(shared_state.dma_channel0);
+    dma_channel_unclaim(shared_state.dma_channel1);
 }
 
 /**
@@ -435,7 +547,8 @@ void audio_i2s_end(void)
  * @return Pointer to actual output format, or NULL on failure
  * 
  * @note Currently supports stereo output only (2 channels)
- * @note Supports 16-bit and 32-bit PCM formats
+ * @note Supports 16-bit and 32-bit PCM output formats; the input format may also be
+ *       stereo F32, which the connection converts with saturation
  */
 const audio_format_t *audio_i2s_setup(const audio_format_t *input_format, 
                                      const audio_format_t *output_format,
@@ -444,24 +557,68 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *input_format,
     // Store format specifications for runtime use
     _i2s_input_audio_format = input_format;
     _i2s_output_audio_format = output_format;
+
+    // Throughput: the PIO must manage two instructions per bit at no more than clk_sys
+    uint32_t max_sample_freq = audio_i2s_get_max_sample_freq(output_format->pcm_format);
+    if (output_format->sample_freq > max_sample_freq) {
+        printf("I2S: %u Hz is above the maximum %u Hz at clk_sys %u Hz\n", (uint) output_format->sample_freq,
+               (uint) max_sample_freq, (uint) clock_get_hz(clk_sys));
+        return NULL;
+    }
     
     // Configure GPIO pins for PIO function
     // All I2S signals (SDATA, BCLK, LRCLK) use the same PIO instance
     uint func = GPIO_FUNC_PIOx;
-    gpio_set_function(config->data_pin, func);          // SDATA pin
+    uint data_line_count = config->data_line_count ? config->data_line_count : 1;
+    assert(data_line_count == 1 || data_line_count == 2 || data_line_count == 4);
+    for (uint line = 0; line < data_line_count; line++) {
+        gpio_set_function(config->data_pin + line, func); // SDATA pin(s)
+    }
     gpio_set_function(config->clock_pin_base, func);    // BCLK pin  
     gpio_set_function(config->clock_pin_base + 1, func); // LRCLK pin
+#if PICO_AUDIO_LATENCY && PICO_AUDIO_I2S_LATENCY_GPIO >= 0
+    // Latency probe marker output for a scope/logic analyser
+    gpio_init(PICO_AUDIO_I2S_LATENCY_GPIO);
+    gpio_set_dir(PICO_AUDIO_I2S_LATENCY_GPIO, GPIO_OUT);
+#endif
     
-    // Claim PIO state machine for exclusive use
-    uint8_t sm = shared_state.pio_sm = config->pio_sm;
-    pio_sm_claim(audio_pio, sm);
+    // Claim PIO state machine for exclusive use (HW_RESOURCE_AUTO picks a free one)
+    int claimed_sm = hw_resource_claim_sm(audio_pio, config->pio_sm);
+    if (claimed_sm < 0) return NULL;
+    uint8_t sm = shared_state.pio_sm = (uint8_t) claimed_sm;
+    
+    // Load I2S PIO program into PIO memory, sharing a copy another driver already loaded
+    if (data_line_count > 1) {
+        audio_i2s_program_patch_lines(multi_line_instructions, &multi_line_program, data_line_count);
+        loaded_program = &multi_line_program;
+    } else {
+        loaded_program = &audio_i2s_program;
+    }
+    shared_state.data_line_count = (uint8_t) data_line_count;
+    int offset = hw_resource_add_pio_program(audio_pio, loaded_program);
+    if (offset < 0) {
+        pio_sm_unclaim(audio_pio, sm);
+        return NULL;
+    }
+    loaded_offset = (uint) offset;
     
-    // Load I2S PIO program into PIO memory
-    loaded_offset = pio_add_program(audio_pio, &audio_i2s_program);
+    // Claim both DMA channels (fixed or HW_RESOURCE_AUTO) until audio_i2s_end(), so a
+    // conflict fails setup here rather than panicking when output is enabled
+    assert((config->dma_channel0 == HW_RESOURCE_AUTO) == (config->dma_channel1 == HW_RESOURCE_AUTO));
+    int channel0 = hw_resource_claim_dma_channel(config->dma_channel0);
+    int channel1 = channel0 < 0 ? -1 : hw_resource_claim_dma_channel(config->dma_channel1);
+    if (channel1 < 0) {
+        if (channel0 >= 0) dma_channel_unclaim((uint) channel0);
+        hw_resource_remove_pio_program(audio_pio, loaded_program);
+        pio_sm_unclaim(audio_pio, sm);
+        return NULL;
+    }
+    uint8_t dma_channel0 = (uint8_t) channel0;
+    uint8_t dma_channel1 = (uint8_t) channel1;
     
     // Validate output format requirements
-    // Current implementation requires stereo output
-    assert(output_format->channel_count == AUDIO_CHANNEL_STEREO);
+    // Current implementation requires stereo output, one stereo pair per data line
+    assert(output_format->channel_count == AUDIO_CHANNEL_STEREO * data_line_count);
     
     // Validate PCM format support (16-bit or 32-bit signed)
     assert(output_format->pcm_format == AUDIO_PCM_FORMAT_S16 || 
@@ -472,11 +629,12 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *input_format,
     
     // Initialize PIO state machine with I2S timing parameters
     audio_i2s_program_init(audio_pio, sm, loaded_offset, 
-                          config->data_pin, config->clock_pin_base, res_bits);
+                          config->data_pin, config->clock_pin_base, res_bits, data_line_count);
     
     // Allocate and initialize silence buffer for underrun protection
     // Buffer size: samples × channels × bytes_per_sample
-    silence_buffer.buffer = pico_buffer_alloc(PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH * 4);
+    silence_buffer.buffer = pico_buffer_alloc(PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH *
+                                              output_format->channel_count * (res_bits / 8));
     silence_buffer.sample_count = PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH;
     silence_buffer.format = &pio_i2s_consumer_buffer_format;
 
@@ -485,8 +643,6 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *input_format,
     __mem_fence_release();
     
     // Store DMA channel assignments in shared state
-    uint8_t dma_channel0 = config->dma_channel0;
-    uint8_t dma_channel1 = config->dma_channel1;
     shared_state.dma_channel0 = dma_channel0;
     shared_state.dma_channel1 = dma_channel1;
     
@@ -561,6 +717,13 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *input_format,
     return output_format;
 }
 
+uint32_t audio_i2s_get_max_sample_freq(audio_pcm_format_t pcm_format) {
+    uint bits = (pcm_format == AUDIO_PCM_FORMAT_S32 || pcm_format == AUDIO_PCM_FORMAT_U32) ? 32 :
+                (pcm_format == AUDIO_PCM_FORMAT_S8 || pcm_format == AUDIO_PCM_FORMAT_U8) ? 8 : 16;
+    // two instructions per bit, one stereo pair per data line, divider >= 1
+    return clock_get_hz(clk_sys) / (2u * AUDIO_CHANNEL_STEREO * bits);
+}
+
 // ============================================================================
 // Internal Helper Functions
 // ============================================================================
@@ -580,7 +743,7 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *input_format,
  * 
  * @param sample_freq Target sampling frequency in Hz
  * @param pcm_format  PCM format (determines bits per sample)
- * @param channel_count Number of audio channels
+ * @param channel_count Number of audio channels (over all data lines)
  * 
  * @note This function can be called at runtime to change sampling frequency
  * @note Frequency changes may cause brief audio interruption
@@ -588,6 +751,9 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *input_format,
 static void update_pio_frequency(uint32_t sample_freq, audio_pcm_format_t pcm_format, audio_channel_t channel_count) 
 {
     printf("Setting PIO frequency for target sampling frequency = %u Hz\n", sample_freq);
+
+    // the data lines run in parallel: BCLK only has to carry one line's channels
+    channel_count = (audio_channel_t) (channel_count / shared_state.data_line_count);
     
     // Get current system clock frequency
     uint32_t system_clock_frequency = clock_get_hz(clk_sys);
@@ -632,6 +798,12 @@ static void update_pio_frequency(uint32_t sample_freq, audio_pcm_format_t pcm_fo
     // Validate divider is within PIO hardware limits
     assert(divider < 0x1000000);  // 24-bit limit
     assert(bits <= 32);           // Maximum supported bit depth
+    if (divider < 0x100u) {
+        // the PIO cannot run faster than clk_sys (an integer part of 0 would divide by 65536)
+        printf("I2S: %u Hz is above the maximum %u Hz, playing at the maximum\n", sample_freq,
+               audio_i2s_get_max_sample_freq(pcm_format));
+        divider = 0x100u;
+    }
     
 #ifdef PIO_CLK_DIV_FRAC
     // Fractional clock division for better frequency accuracy
@@ -639,6 +811,11 @@ static void update_pio_frequency(uint32_t sample_freq, audio_pcm_format_t pcm_fo
     float pio_freq = (float) system_clock_frequency * 256 / divider;
     printf("System clock: %u Hz, I2S divider: %u/256, PIO freq: %.4f Hz\n", 
            system_clock_frequency, divider, pio_freq);
+    if ((divider & 0xffu) && divider < 0x400u) {
+        // a fractional step is a whole clk_sys period: a large part of a bit at high rates
+        printf("I2S: fractional divider at %u Hz, BCLK jitter %u ns; use a clk_sys multiple of %.0f Hz\n",
+               sample_freq, (uint) (1000000000u / system_clock_frequency), pio_freq);
+    }
     
     // Apply fractional divider (may introduce slight jitter)
     pio_sm_set_clkdiv_int_frac(audio_pio, shared_state.pio_sm, 
@@ -661,10 +838,52 @@ static void update_pio_frequency(uint32_t sample_freq, audio_pcm_format_t pcm_fo
     shared_state.freq = sample_freq;
 }
 
+/**
+ * @brief Consumer take for several data lines: stereo pairs to bit planes
+ */
+static audio_buffer_t *multi_line_consumer_take(audio_connection_t *connection, bool block) {
+    assert(_i2s_input_audio_format->pcm_format == _i2s_output_audio_format->pcm_format &&
+           _i2s_input_audio_format->channel_count == _i2s_output_audio_format->channel_count);
+    bool s32 = _i2s_output_audio_format->pcm_format == AUDIO_PCM_FORMAT_S32;
+    if (shared_state.data_line_count == 2) {
+        return s32 ? i2s_lines2_s32_consumer_take(connection, block) : i2s_lines2_s16_consumer_take(connection, block);
+    } else {
+        return s32 ? i2s_lines4_s32_consumer_take(connection, block) : i2s_lines4_s16_consumer_take(connection, block);
+    }
+}
+
+/**
+ * @brief Producer give for several data lines: stereo pairs to bit planes
+ */
+static void multi_line_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    assert(_i2s_input_audio_format->pcm_format == _i2s_output_audio_format->pcm_format &&
+           _i2s_input_audio_format->channel_count == _i2s_output_audio_format->channel_count);
+    bool s32 = _i2s_output_audio_format->pcm_format == AUDIO_PCM_FORMAT_S32;
+    if (shared_state.data_line_count == 2) {
+        s32 ? i2s_lines2_s32_producer_give(connection, buffer) : i2s_lines2_s16_producer_give(connection, buffer);
+    } else {
+        s32 ? i2s_lines4_s32_producer_give(connection, buffer) : i2s_lines4_s16_producer_give(connection, buffer);
+    }
+}
+
+/**
+ * @brief Default consumer buffer length for a sample rate
+ *
+ * 256 frames up to PICO_AUDIO_I2S_HIGH_RATE_THRESHOLD, then larger DMA
+ * transfers so the IRQ rate does not grow with the sample rate.
+ */
+static uint default_buffer_frames(uint32_t sample_freq) {
+    if (sample_freq <= PICO_AUDIO_I2S_HIGH_RATE_THRESHOLD) return 256;
+    return 256 * ((sample_freq + PICO_AUDIO_I2S_HIGH_RATE_THRESHOLD - 1) / PICO_AUDIO_I2S_HIGH_RATE_THRESHOLD);
+}
+
 static audio_buffer_t *wrap_consumer_take(audio_connection_t *connection, bool block) {
     // support dynamic frequency shifting
     if (connection->producer_pool->format->sample_freq != shared_state.freq) {
-        update_pio_frequency(connection->producer_pool->format->sample_freq, connection->producer_pool->format->pcm_format, connection->producer_pool->format->channel_count);
+        update_pio_frequency(connection->producer_pool->format->sample_freq, _i2s_output_audio_format->pcm_format, connection->producer_pool->format->channel_count);
+    }
+    if (shared_state.data_line_count > 1) {
+        return multi_line_consumer_take(connection, block);
     }
     if (_i2s_input_audio_format->pcm_format == _i2s_output_audio_format->pcm_format) {
         if (_i2s_input_audio_format->channel_count == AUDIO_CHANNEL_MONO && _i2s_input_audio_format->channel_count == AUDIO_CHANNEL_MONO) {
@@ -685,6 +904,17 @@ static audio_buffer_t *wrap_consumer_take(audio_connection_t *connection, bool b
         } else {
             assert(false); // unsupported
         }
+    } else if (_i2s_input_audio_format->pcm_format == AUDIO_PCM_FORMAT_F32 &&
+               _i2s_input_audio_format->channel_count == AUDIO_CHANNEL_STEREO) {
+        // float renderers: saturating conversion once per buffer, here
+        switch (_i2s_output_audio_format->pcm_format) {
+            case AUDIO_PCM_FORMAT_S16:
+                return stereo_f32_to_stereo_s16_consumer_take(connection, block);
+            case AUDIO_PCM_FORMAT_S32:
+                return stereo_f32_to_stereo_s32_consumer_take(connection, block);
+            default:
+                assert(false);
+        }
     } else {
         assert(false); // unsupported
     }
@@ -693,7 +923,11 @@ static audio_buffer_t *wrap_consumer_take(audio_connection_t *connection, bool b
 static void wrap_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
     // support dynamic frequency shifting
     if (connection->producer_pool->format->sample_freq != shared_state.freq) {
-        update_pio_frequency(connection->producer_pool->format->sample_freq, connection->producer_pool->format->pcm_format, connection->producer_pool->format->channel_count);
+        update_pio_frequency(connection->producer_pool->format->sample_freq, _i2s_output_audio_format->pcm_format, connection->producer_pool->format->channel_count);
+    }
+    if (shared_state.data_line_count > 1) {
+        multi_line_producer_give(connection, buffer);
+        return;
     }
     if (_i2s_input_audio_format->pcm_format == _i2s_output_audio_format->pcm_format) {
         if (_i2s_input_audio_format->channel_count == AUDIO_CHANNEL_MONO && _i2s_input_audio_format->channel_count == AUDIO_CHANNEL_MONO) {
@@ -716,6 +950,16 @@ static void wrap_producer_give(audio_connection_t *connection, audio_buffer_t *b
         } else {
             assert(false); // unsupported
         }
+    } else if (_i2s_input_audio_format->pcm_format == AUDIO_PCM_FORMAT_F32 &&
+               _i2s_input_audio_format->channel_count == AUDIO_CHANNEL_STEREO) {
+        switch (_i2s_output_audio_format->pcm_format) {
+            case AUDIO_PCM_FORMAT_S16:
+                return stereo_f32_to_stereo_s16_producer_give(connection, buffer);
+            case AUDIO_PCM_FORMAT_S32:
+                return stereo_f32_to_stereo_s32_producer_give(connection, buffer);
+            default:
+                assert(false);
+        }
     } else {
         assert(false); // unsupported
     }
@@ -739,24 +983,59 @@ static struct producer_pool_blocking_give_connection m2s_audio_i2s_pg_connection
         }
 };
 
+void audio_i2s_set_flush_policy(audio_flush_policy_t policy) {
+    m2s_audio_i2s_pg_connection.flush_policy = policy;
+}
+
+void audio_i2s_request_flush(void) {
+    m2s_audio_i2s_pg_connection.flush_requested = true;
+}
+
+static audio_connection_t passthru_connection = {
+        .producer_pool_take = producer_pool_take_buffer_default,
+        .producer_pool_give = producer_pool_give_buffer_default,
+        .consumer_pool_take = passthru_consumer_take,
+        .consumer_pool_give = passthru_consumer_give,
+};
+
+bool audio_i2s_connect_passthru(audio_buffer_pool_t *producer) {
+    printf("Connecting PIO I2S audio (passthru)\n");
+    // the DMA reads the producer's buffers directly, so no conversion (or bit plane transpose) is possible
+    if (shared_state.data_line_count > 1 ||
+        producer->format->pcm_format != _i2s_output_audio_format->pcm_format ||
+        producer->format->channel_count != _i2s_output_audio_format->channel_count) {
+        return false;
+    }
+    configure_consumer_format(producer->format->sample_freq);
+    // an empty pool: it only carries the connection
+    audio_i2s_consumer = audio_new_consumer_pool(&pio_i2s_consumer_buffer_format, 0, 0);
+    update_pio_frequency(producer->format->sample_freq, _i2s_output_audio_format->pcm_format,
+                         producer->format->channel_count);
+    shared_state.passthru = true;
+    __mem_fence_release();
+    audio_complete_connection(&passthru_connection, producer, audio_i2s_consumer);
+    return true;
+}
+
 bool audio_i2s_connect_thru(audio_buffer_pool_t *producer, audio_connection_t *connection) {
-    return audio_i2s_connect_extra(producer, false, 2, 256, connection);
+    return audio_i2s_connect_extra(producer, false, 2, default_buffer_frames(producer->format->sample_freq),
+                                   connection);
 }
 
 bool audio_i2s_connect(audio_buffer_pool_t *producer) {
     return audio_i2s_connect_thru(producer, NULL);
 }
 
-bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give, uint buffer_count,
-                                 uint samples_per_buffer, audio_connection_t *connection) {
-    printf("Connecting PIO I2S audio\n");
-
-    // todo we need to pick a connection based on the frequency - e.g. 22050 can be more simply upsampled to 44100
-    assert(producer->format->pcm_format == AUDIO_PCM_FORMAT_S16 || producer->format->pcm_format == AUDIO_PCM_FORMAT_S32);
+/**
+ * @brief Set the consumer (DMA side) format to the output format at a given rate
+ *
+ * @param sample_freq Sampling frequency of the stream being played
+ */
+static void configure_consumer_format(uint32_t sample_freq) {
     pio_i2s_consumer_format.pcm_format = _i2s_output_audio_format->pcm_format;
     // todo we could do mono
     // todo we can't match exact, so we should return what we can do
-    pio_i2s_consumer_format.sample_freq = producer->format->sample_freq;
+    pio_i2s_consumer_format.sample_freq = sample_freq;
     pio_i2s_consumer_format.channel_count = _i2s_output_audio_format->channel_count;
     switch (_i2s_output_audio_format->pcm_format) {
         case AUDIO_PCM_FORMAT_S8:
@@ -775,13 +1054,16 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
             assert(false);
             break;
     }
+}
 
-    audio_i2s_consumer = audio_new_consumer_pool(&pio_i2s_consumer_buffer_format, buffer_count, samples_per_buffer);
-
-    update_pio_frequency(producer->format->sample_freq, producer->format->pcm_format, producer->format->channel_count);
+bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give, uint buffer_count,
+                                 uint samples_per_buffer, audio_connection_t *connection) {
+    printf("Connecting PIO I2S audio\n");
 
-    // todo cleanup threading
-    __mem_fence_release();
+    // todo we need to pick a connection based on the frequency - e.g. 22050 can be more simply upsampled to 44100
+    assert(producer->format->pcm_format == AUDIO_PCM_FORMAT_S16 || producer->format->pcm_format == AUDIO_PCM_FORMAT_S32 ||
+           producer->format->pcm_format == AUDIO_PCM_FORMAT_F32);
+    configure_consumer_format(producer->format->sample_freq);
 
     if (!connection) {
         if (producer->format->channel_count == AUDIO_CHANNEL_STEREO) {
@@ -803,10 +1085,81 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
         }
         connection = buffer_on_give ? &m2s_audio_i2s_pg_connection.core : &m2s_audio_i2s_ct_connection.core;
     }
+
+    return audio_i2s_connect_with_pool(producer,
+                                       audio_new_consumer_pool(&pio_i2s_consumer_buffer_format, buffer_count,
+                                                               samples_per_buffer),
+                                       connection);
+}
+
+bool audio_i2s_connect_with_pool(audio_buffer_pool_t *producer, audio_buffer_pool_t *consumer,
+                                 audio_connection_t *connection) {
+    // the DMA plays the consumer buffers as they are
+    assert(consumer->type == ac_consumer);
+    assert(consumer->format->pcm_format == _i2s_output_audio_format->pcm_format &&
+           consumer->format->channel_count == _i2s_output_audio_format->channel_count);
+    // silence buffer stride follows the output format
+    configure_consumer_format(producer->format->sample_freq);
+
+    audio_i2s_consumer = consumer;
+
+    update_pio_frequency(producer->format->sample_freq, _i2s_output_audio_format->pcm_format, producer->format->channel_count);
+
+    // todo cleanup threading
+    __mem_fence_release();
+
+    if (!connection) {
+        connection = &m2s_audio_i2s_ct_connection.core;
+    }
     audio_complete_connection(connection, producer, audio_i2s_consumer);
     return true;
 }
 
+bool audio_i2s_set_render_callback(audio_i2s_render_callback_t callback, void *ctx, uint frames_per_buffer) {
+    // drop any previous render buffers
+    if (render_state.callback) {
+        render_state.callback = NULL;
+        __mem_fence_release();
+        for (uint i = 0; i < 2; i++) {
+            free(render_state.buffers[i].buffer->bytes);
+            free(render_state.buffers[i].buffer);
+            render_state.buffers[i].buffer = NULL;
+        }
+    }
+    if (!callback) return true;
+
+    assert(_i2s_output_audio_format && !audio_i2s_consumer);
+    assert(frames_per_buffer);
+    // the callback writes the DMA buffers directly, with no bit plane transpose
+    if (shared_state.data_line_count > 1) return false;
+    printf("Connecting PIO I2S audio (render callback, %u frames)\n", frames_per_buffer);
+    configure_consumer_format(_i2s_output_audio_format->sample_freq);
+
+    for (uint i = 0; i < 2; i++) {
+        audio_buffer_t *ab = &render_state.buffers[i];
+        ab->buffer = pico_buffer_alloc(frames_per_buffer * pio_i2s_consumer_buffer_format.sample_stride);
+        if (!ab->buffer) {
+            if (i) {
+                free(render_state.buffers[0].buffer->bytes);
+                free(render_state.buffers[0].buffer);
+            }
+            return false;
+        }
+        ab->format = &pio_i2s_consumer_buffer_format;
+        ab->max_sample_count = frames_per_buffer;
+        ab->sample_count = frames_per_buffer;
+    }
+
+    update_pio_frequency(pio_i2s_consumer_format.sample_freq, pio_i2s_consumer_format.pcm_format,
+                         pio_i2s_consumer_format.channel_count);
+
+    render_state.ctx = ctx;
+    render_state.frame_pos = 0;
+    __mem_fence_release();
+    render_state.callback = callback;
+    return true;
+}
+
 static struct buffer_copying_on_consumer_take_connection m2s_audio_i2s_connection_s8_mono = {
         .core = {
                 .consumer_pool_take = mono_s8_to_mono_consumer_take,
@@ -907,6 +1260,66 @@ bool audio_i2s_connect_s8(audio_buffer_pool_t *producer) {
     return true;
 }
 
+/**
+ * @brief Fill one render mode buffer through the render callback
+ *
+ * @param index Buffer index (0 for dma_channel0, 1 for dma_channel1)
+ */
+static void __time_critical_func(audio_i2s_render_buffer)(uint index) {
+    audio_buffer_t *ab = &render_state.buffers[index];
+    render_state.callback(render_state.ctx, (int32_t *) ab->buffer->bytes, ab->sample_count, render_state.frame_pos);
+    render_state.frame_pos += ab->sample_count;
+#if PICO_AUDIO_I2S_VERIFY
+    audio_verify_check_buffer(ab, time_us_32());
+#endif
+}
+
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+/**
+ * @brief Render every buffer flagged by the DMA IRQ
+ */
+static void __time_critical_func(audio_i2s_render_pending)(void) {
+    uint32_t save = save_and_disable_interrupts();
+    uint pending = deferred_state.render_pending;
+    deferred_state.render_pending = 0;
+    restore_interrupts(save);
+    for (uint i = 0; i < 2; i++) {
+        if (pending & (1u << i)) audio_i2s_render_buffer(i);
+    }
+}
+
+static void __isr __time_critical_func(audio_i2s_callback_irq_handler)(void) {
+    if (render_state.callback) {
+        audio_i2s_render_pending();
+    }
+#ifndef CORE1_PROCESS_I2S_CALLBACK
+    uint32_t save = save_and_disable_interrupts();
+    uint callbacks = deferred_state.callbacks;
+    deferred_state.callbacks = 0;
+    restore_interrupts(save);
+    while (callbacks--) {
+        i2s_callback_func();
+    }
+#endif
+}
+#endif // PICO_AUDIO_I2S_DEFER_CALLBACK
+
+/**
+ * @brief Hand post-transfer work to the callback context
+ *
+ * Called at the end of each DMA IRQ once the next transfer is armed.
+ */
+static inline void audio_i2s_transfer_started(void) {
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+#ifndef CORE1_PROCESS_I2S_CALLBACK
+    deferred_state.callbacks++;
+#endif
+    irq_set_pending((uint) deferred_state.irq);
+#elif !defined(CORE1_PROCESS_I2S_CALLBACK)
+    i2s_callback_func();
+#endif
+}
+
 static inline void audio_start_dma_transfer(uint8_t dma_channel, dma_channel_config *dma_config, audio_buffer_t **playing_buffer) {
     assert(!*playing_buffer);
 
@@ -928,10 +1341,51 @@ static inline void audio_start_dma_transfer(uint8_t dma_channel, dma_channel_con
     }
     #endif // WATCH_PIO_SM_TX_FIFO_LEVEL
 
-    audio_buffer_t *ab = take_audio_buffer(audio_i2s_consumer, false);
+    audio_buffer_t *ab;
+    const audio_buffer_segment_t *segment = NULL;
+    if (render_state.callback) {
+        // pull mode: the channel that just finished is refilled in place; it
+        // won't be read again until the other channel's buffer has played
+        uint index = dma_channel == shared_state.dma_channel0 ? 0 : 1;
+        ab = &render_state.buffers[index];
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+        deferred_state.render_pending |= (uint8_t) (1u << index);
+#else
+        audio_i2s_render_buffer(index);
+#endif
+    } else {
+        if (shared_state.segmented_buffer) {
+            // carry on with the fragments of the buffer the other channel started
+            ab = shared_state.segmented_buffer;
+        } else {
+            ab = take_audio_buffer(audio_i2s_consumer, false);
+#if PICO_AUDIO_I2S_VERIFY
+            if (!ab || !ab->segments) audio_verify_check_buffer(ab, time_us_32());
+#endif
+        }
+        if (ab && ab->segments) {
+            // one transfer per fragment, alternating channels like whole buffers;
+            // only the channel playing the last fragment hands the buffer back
+            assert(ab->segment_count);
+            segment = &ab->segments[shared_state.next_segment++];
+            bool last = shared_state.next_segment == ab->segment_count;
+            shared_state.segmented_buffer = last ? NULL : ab;
+            if (last) shared_state.next_segment = 0;
+            *playing_buffer = last ? ab : NULL;
+        } else {
+            *playing_buffer = ab;
+        }
+    }
+#if PICO_AUDIO_LATENCY
+    // high for the duration of the transfer that carries the probe marker
+    bool __unused marker_started = audio_latency_check_buffer(ab && !ab->segments ? ab : NULL, time_us_32());
+#if PICO_AUDIO_I2S_LATENCY_GPIO >= 0
+    gpio_put(PICO_AUDIO_I2S_LATENCY_GPIO, marker_started);
+#endif
+#endif
 
-    *playing_buffer = ab;
     if (!ab) {
+        audio_trace(AUDIO_TRACE_UNDERRUN, dma_channel);
         DEBUG_PINS_XOR(audio_timing, 1);
         DEBUG_PINS_XOR(audio_timing, 2);
         DEBUG_PINS_XOR(audio_timing, 1);
@@ -939,29 +1393,32 @@ static inline void audio_start_dma_transfer(uint8_t dma_channel, dma_channel_con
         // just play some silence
         ab = &silence_buffer;
     }
-    assert(ab->sample_count);
+    const uint8_t *src = segment ? segment->bytes : ab->buffer->bytes;
+    uint32_t sample_count = segment ? segment->sample_count : ab->sample_count;
+    assert(sample_count);
+#if PICO_AUDIO_TAP
+    // exactly what the PIO is about to play; the bit planes of several data lines
+    // are not frames, and deferred render buffers are not filled yet
+    if (shared_state.data_line_count == 1 && !(PICO_AUDIO_I2S_DEFER_CALLBACK && render_state.callback)) {
+        audio_tap_write(AUDIO_TAP_I2S_OUTPUT, ab->format->format, src, sample_count);
+    }
+#endif
     // todo better naming of format->format->format!!
     assert(ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S16 || ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S32);
     if (_i2s_output_audio_format->channel_count == AUDIO_CHANNEL_MONO) {
         assert(ab->format->format->channel_count == AUDIO_CHANNEL_MONO);
         //assert(ab->format->sample_stride == 2);
     } else {
-        assert(ab->format->format->channel_count == AUDIO_CHANNEL_STEREO);
+        assert(ab->format->format->channel_count == AUDIO_CHANNEL_STEREO * shared_state.data_line_count);
         //assert(ab->format->sample_stride == 4);
     }
-    uint transfer_size;
-    if (ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S32 && ab->format->format->channel_count == AUDIO_CHANNEL_STEREO) {
-        transfer_size = ab->sample_count * 2;
-        //dma_channel_transfer_from_buffer_now(dma_channel, ab->buffer->bytes, ab->sample_count*2); // DMA_SIZE_32 * 2 times;
-    } else {
-        transfer_size = ab->sample_count;
-        //dma_channel_transfer_from_buffer_now(dma_channel, ab->buffer->bytes, ab->sample_count);
-    }
+    // DMA_SIZE_32: one transfer per 32 bit word of frames (S16 stereo: 1, S32 stereo: 2, x data lines)
+    uint transfer_size = sample_count * ab->format->sample_stride / 4;
     dma_channel_configure(
         dma_channel,
         dma_config,
         &audio_pio->txf[shared_state.pio_sm], // dest
-        ab->buffer->bytes, // src
+        src, // src
         transfer_size, // count
         false // trigger
     );
@@ -975,6 +1432,7 @@ void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
     uint dma_channel0 = shared_state.dma_channel0;
     uint dma_channel1 = shared_state.dma_channel1;
     if (dma_irqn_get_channel_status(PICO_AUDIO_I2S_DMA_IRQ, dma_channel0)) {
+        audio_trace(AUDIO_TRACE_DMA_IRQ_ENTER, dma_channel0);
         dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel0);
         DEBUG_PINS_SET(audio_timing, 4);
         // free the buffer we just finished
@@ -989,10 +1447,11 @@ void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
 #ifdef CORE1_PROCESS_I2S_CALLBACK
         bool flg = multicore_fifo_push_timeout_us(EVENT_I2S_DMA_TRANSFER_STARTED, FIFO_TIMEOUT);
         if (!flg) { printf("Core0 -> Core1 FIFO Full\n"); }
-#else
-        i2s_callback_func();
 #endif // CORE1_PROCESS_I2S_CALLBACK
+        audio_i2s_transfer_started();
+        audio_trace(AUDIO_TRACE_DMA_IRQ_EXIT, dma_channel0);
     } else if (dma_irqn_get_channel_status(PICO_AUDIO_I2S_DMA_IRQ, dma_channel1)) {
+        audio_trace(AUDIO_TRACE_DMA_IRQ_ENTER, dma_channel1);
         dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel1);
         DEBUG_PINS_SET(audio_timing, 4);
         // free the buffer we just finished
@@ -1007,13 +1466,165 @@ void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
 #ifdef CORE1_PROCESS_I2S_CALLBACK
         bool flg = multicore_fifo_push_timeout_us(EVENT_I2S_DMA_TRANSFER_STARTED, FIFO_TIMEOUT);
         if (!flg) { printf("Core0 -> Core1 FIFO Full\n"); }
-#else
-        i2s_callback_func();
 #endif // CORE1_PROCESS_I2S_CALLBACK
+        audio_i2s_transfer_started();
+        audio_trace(AUDIO_TRACE_DMA_IRQ_EXIT, dma_channel1);
     }
 #endif
 }
 
+/**
+ * @brief Let the playing transfer finish and stop there (DMA IRQ masked)
+ *
+ * Both channels have their chaining pointed at themselves, so whichever
+ * transfer is running (or gets chained before the patch lands) is the last.
+ */
+static void stop_at_buffer_boundary(void) {
+    uint dma_channel[2] = {shared_state.dma_channel0, shared_state.dma_channel1};
+    for (uint i = 0; i < 2; i++) {
+        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel[i], false);
+    }
+    for (uint i = 0; i < 2; i++) {
+        // al1_ctrl is the non-triggering alias of CTRL
+        uint32_t ctrl = dma_hw->ch[dma_channel[i]].al1_ctrl;
+        ctrl = (ctrl & ~DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS) | (dma_channel[i] << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB);
+        dma_hw->ch[dma_channel[i]].al1_ctrl = ctrl;
+    }
+    for (uint i = 0; i < 2; i++) {
+        dma_channel_wait_for_finish_blocking(dma_channel[i]);
+        dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel[i]);
+    }
+    // the FIFO drains, then the state machine stalls on autopull at a channel boundary
+    while (!pio_sm_is_tx_fifo_empty(audio_pio, shared_state.pio_sm)) tight_loop_contents();
+}
+
+bool audio_i2s_switch_format(audio_buffer_pool_t *producer, const audio_format_t *output_format) {
+    audio_connection_t *connection = audio_i2s_consumer ? audio_i2s_consumer->connection : NULL;
+    bool on_give = connection == &m2s_audio_i2s_pg_connection.core;
+    if (!on_give && connection != &m2s_audio_i2s_ct_connection.core) return false;
+    if (output_format->pcm_format != AUDIO_PCM_FORMAT_S16 && output_format->pcm_format != AUDIO_PCM_FORMAT_S32) {
+        return false;
+    }
+    if (output_format->channel_count != _i2s_output_audio_format->channel_count ||
+        producer->format->channel_count != output_format->channel_count ||
+        (producer->format->pcm_format != output_format->pcm_format &&
+         producer->format->pcm_format != AUDIO_PCM_FORMAT_F32) ||
+        (shared_state.data_line_count > 1 && producer->format->pcm_format != output_format->pcm_format) ||
+        producer->format->sample_freq > audio_i2s_get_max_sample_freq(output_format->pcm_format)) {
+        return false;
+    }
+
+    // enabled means armed or running: a start may still be waiting for
+    // audio_i2s_attach_irq(), and a disable from the other core leaves the
+    // handler attached, so attached_core alone says nothing about the DMA
+    bool armed = shared_state.enabled && irq_affinity.start_pending;
+    bool running = shared_state.enabled && !armed;
+    if (running) stop_at_buffer_boundary();
+
+    // the ISR bit count can only be reloaded with the state machine paused and its FIFO empty
+    uint sm = shared_state.pio_sm;
+    uint res_bits = output_format->pcm_format == AUDIO_PCM_FORMAT_S32 ? 32 : 16;
+    pio_sm_set_enabled(audio_pio, sm, false);
+    pio_sm_clear_fifos(audio_pio, sm);
+    pio_sm_restart(audio_pio, sm);
+    audio_i2s_program_load_res_bits(audio_pio, sm, res_bits);
+    pio_sm_exec(audio_pio, sm, pio_encode_jmp(loaded_offset + audio_i2s_offset_entry_point));
+    pio_sm_set_enabled(audio_pio, sm, true);
+
+    // everything the DMA held or was about to play is in the old format
+    if (shared_state.playing_buffer0) give_audio_buffer(audio_i2s_consumer, shared_state.playing_buffer0);
+    if (shared_state.playing_buffer1) give_audio_buffer(audio_i2s_consumer, shared_state.playing_buffer1);
+    shared_state.playing_buffer0 = NULL;
+    shared_state.playing_buffer1 = NULL;
+    shared_state.segmented_buffer = NULL;
+    shared_state.next_segment = 0;
+    if (on_give) {
+        if (m2s_audio_i2s_pg_connection.current_consumer_buffer) {
+            give_audio_buffer(audio_i2s_consumer, m2s_audio_i2s_pg_connection.current_consumer_buffer);
+            m2s_audio_i2s_pg_connection.current_consumer_buffer = NULL;
+        }
+        audio_buffer_t *ab;
+        while ((ab = take_audio_buffer(audio_i2s_consumer, false)) != NULL) {
+            give_audio_buffer(audio_i2s_consumer, ab);
+        }
+    } else if (m2s_audio_i2s_ct_connection.current_producer_buffer) {
+        queue_free_audio_buffer(connection->producer_pool, m2s_audio_i2s_ct_connection.current_producer_buffer);
+        m2s_audio_i2s_ct_connection.current_producer_buffer = NULL;
+    }
+
+    _i2s_input_audio_format = producer->format;
+    _i2s_output_audio_format = output_format;
+    configure_consumer_format(producer->format->sample_freq);
+    // same memory, a different number of frames
+    uint stride = pio_i2s_consumer_buffer_format.sample_stride;
+    for (audio_buffer_t *ab = audio_i2s_consumer->free_list; ab; ab = ab->next) {
+        ab->max_sample_count = ab->buffer->size / stride;
+        ab->sample_count = 0;
+    }
+    silence_buffer.sample_count = silence_buffer.buffer->size / stride;
+    audio_complete_connection(connection, producer, audio_i2s_consumer);
+    update_pio_frequency(producer->format->sample_freq, output_format->pcm_format, producer->format->channel_count);
+    __mem_fence_release();
+
+    if (armed || running) {
+        // both word lengths use 32 bit DMA transfers; only the count changes, per buffer
+        audio_start_dma_transfer(shared_state.dma_channel0, &dma_config0, &shared_state.playing_buffer0);
+        audio_start_dma_transfer(shared_state.dma_channel1, &dma_config1, &shared_state.playing_buffer1);
+    }
+    if (running) {
+        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, shared_state.dma_channel0, true);
+        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, shared_state.dma_channel1, true);
+        dma_channel_start(shared_state.dma_channel0);
+    }
+    // armed: audio_i2s_attach_irq() starts the re-armed transfers as before
+    return true;
+}
+
+void audio_i2s_set_irq_core(int core) {
+    assert(core >= -1 && core < NUM_CORES);
+#ifdef CORE1_PROCESS_I2S_CALLBACK
+    assert(core != 1); // core1 is taken by i2s_callback_loop
+#endif
+    irq_affinity.core = (int8_t) core;
+}
+
+bool audio_i2s_attach_irq(void) {
+    if (!irq_affinity.start_pending) return false;
+    irq_affinity.start_pending = false;
+    uint dma_channel0 = shared_state.dma_channel0;
+    uint dma_channel1 = shared_state.dma_channel1;
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+    // user IRQs are per core, so the callback IRQ is claimed on the DMA IRQ core
+    if (deferred_state.irq < 0) {
+        deferred_state.irq = user_irq_claim_unused(true);
+        irq_set_exclusive_handler((uint) deferred_state.irq, audio_i2s_callback_irq_handler);
+        irq_set_priority((uint) deferred_state.irq, PICO_AUDIO_I2S_CALLBACK_IRQ_PRIORITY);
+    }
+    irq_set_enabled((uint) deferred_state.irq, true);
+#endif
+    // other drivers may share DMA_IRQ_x; the line stays enabled while any of them is on it
+    hw_resource_add_shared_irq_handler(DMA_IRQ_x, audio_i2s_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel0, true);
+    dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel1, true);
+    irq_affinity.attached_core = (int8_t) get_core_num();
+    dma_channel_start(dma_channel0);
+    return true;
+}
+
+void audio_i2s_detach_irq(void) {
+    if (irq_affinity.attached_core != (int8_t) get_core_num()) return;
+    hw_resource_remove_shared_irq_handler(DMA_IRQ_x, audio_i2s_dma_irq_handler);
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+    if (deferred_state.irq >= 0) {
+        irq_set_enabled((uint) deferred_state.irq, false);
+        irq_remove_handler((uint) deferred_state.irq, audio_i2s_callback_irq_handler);
+        user_irq_unclaim((uint) deferred_state.irq);
+        deferred_state.irq = -1;
+    }
+#endif
+    irq_affinity.attached_core = -1;
+}
+
 void audio_i2s_set_enabled(bool enabled) {
 #ifndef NDEBUG
     if (enabled) {
@@ -1026,17 +1637,22 @@ void audio_i2s_set_enabled(bool enabled) {
     uint dma_channel1 = shared_state.dma_channel1;
 
     if (enabled) {
-        dma_channel_claim(dma_channel0);
-        dma_channel_claim(dma_channel1);
         audio_start_dma_transfer(dma_channel0, &dma_config0, &shared_state.playing_buffer0);
         audio_start_dma_transfer(dma_channel1, &dma_config1, &shared_state.playing_buffer1);
-        if (!irq_has_shared_handler(DMA_IRQ_x)) {
-            irq_add_shared_handler(DMA_IRQ_x, audio_i2s_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+        // render the first two buffers now, before anything plays
+        if (render_state.callback) {
+            audio_i2s_render_pending();
+        }
+#endif
+        // the IRQ handler is installed (and DMA started) on the chosen core;
+        // if that is another core, it finishes the job in audio_i2s_attach_irq()
+        shared_state.enabled = true;
+        __mem_fence_release();
+        irq_affinity.start_pending = true;
+        if (irq_affinity.core < 0 || irq_affinity.core == (int) get_core_num()) {
+            audio_i2s_attach_irq();
         }
-        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel0, true);
-        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel1, true);
-        irq_set_enabled(DMA_IRQ_x, true);
-        dma_channel_start(dma_channel0);
 #ifdef CORE1_PROCESS_I2S_CALLBACK
         {
             bool flg;
@@ -1064,21 +1680,24 @@ void audio_i2s_set_enabled(bool enabled) {
             }
         }
 #endif // CORE1_PROCESS_I2S_CALLBACK
+        irq_affinity.start_pending = false;
+        shared_state.enabled = false;
+        // masking at the DMA works from either core; the NVIC side can only
+        // be released on the core that attached it
         dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel0, false);
         dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel1, false);
-        irq_set_enabled(DMA_IRQ_x, false);
+        audio_i2s_detach_irq();
         dma_channel_abort(dma_channel0);
         dma_channel_wait_for_finish_blocking(dma_channel0);
         dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel0);
         dma_channel_cleanup(dma_channel0);
-        dma_channel_unclaim(dma_channel0);
         dma_channel_abort(dma_channel1);
         dma_channel_wait_for_finish_blocking(dma_channel1);
         dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel1);
         dma_channel_cleanup(dma_channel1);
-        dma_channel_unclaim(dma_channel1);
-        if (!irq_has_shared_handler(DMA_IRQ_x)) {
-            irq_remove_handler(DMA_IRQ_x, audio_i2s_dma_irq_handler);
-        }
+#if PICO_AUDIO_I2S_DEFER_CALLBACK
+        deferred_state.render_pending = 0;
+        deferred_state.callbacks = 0;
+#endif
     }
 }
@@ -11,6 +11,7 @@
 #define _PICO_AUDIO_I2S_H
 
 #include "pico/audio.h"
+#include "pico/hw_resource.h"
 
 /**
  * @file audio_i2s.h
@@ -26,11 +27,12 @@
  * @section features Key Features
  * 
  * - **High Resolution Audio**: 16-bit and 32-bit PCM support
- * - **Wide Sample Rate Range**: 8 kHz to 192 kHz
+ * - **Wide Sample Rate Range**: 8 kHz to 768 kHz (see audio_i2s_get_max_sample_freq())
  * - **Low Latency**: DMA-based streaming with minimal CPU overhead
  * - **Dual Core Support**: Optional Core1 callback processing
  * - **Professional Quality**: Jitter-free output using PIO state machines
  * - **Flexible Configuration**: Configurable GPIO pins and DMA channels
+ * - **Multiple Data Lines**: Up to 4 stereo DACs on one state machine (data_line_count)
  *
  * @section usage Basic Usage Example
  * 
@@ -74,7 +76,8 @@
  * - **CPU Usage**: <5% at 44.1 kHz/32-bit (measured on RP2040 @ 125MHz)
  * - **Memory Usage**: ~14KB for triple buffering (1156 samples/buffer)
  * - **Latency**: <30ms total system latency
- * - **Maximum Sample Rate**: 192 kHz (limited by PIO clock and system performance)
+ * - **Maximum Sample Rate**: clk_sys / (4 × bits per sample), e.g. 976 kHz for S32 at
+ *   125 MHz; checked at setup, see audio_i2s_get_max_sample_freq()
  */
 
 #ifdef __cplusplus
@@ -106,6 +109,29 @@ extern "C" {
 #endif
 #endif
 
+/**
+ * @brief Run callbacks in a lower-priority software IRQ instead of the DMA IRQ
+ *
+ * When set to 1, the DMA IRQ only re-arms the next transfer and pends a
+ * user IRQ (claimed with user_irq_claim_unused()) in which the render
+ * callback and i2s_callback_func() run. Audio re-arming stays in the
+ * microsecond range and other DMA users sharing the IRQ are not blocked by
+ * audio rendering. When 0, callbacks run inline at the end of the DMA IRQ.
+ */
+#ifndef PICO_AUDIO_I2S_DEFER_CALLBACK
+#define PICO_AUDIO_I2S_DEFER_CALLBACK 1
+#endif
+
+/**
+ * @brief NVIC priority of the deferred callback IRQ
+ *
+ * Must be numerically higher (lower priority) than the DMA IRQ, which uses
+ * PICO_DEFAULT_IRQ_PRIORITY unless changed by the application.
+ */
+#ifndef PICO_AUDIO_I2S_CALLBACK_IRQ_PRIORITY
+#define PICO_AUDIO_I2S_CALLBACK_IRQ_PRIORITY 0xc0
+#endif
+
 /**
  * @brief PIO instance selection (0 or 1)
  * 
@@ -187,6 +213,18 @@ extern "C" {
 #endif
 #endif
 
+/**
+ * @brief Sample rate above which the default consumer buffers grow
+ *
+ * audio_i2s_connect() / audio_i2s_connect_thru() use 256 frame consumer
+ * buffers up to this rate, and a multiple of 256 frames above it, so the
+ * DMA IRQ rate (and the time the IRQ has to re-arm a channel) stays that of
+ * this rate at 384/768 kHz.
+ */
+#ifndef PICO_AUDIO_I2S_HIGH_RATE_THRESHOLD
+#define PICO_AUDIO_I2S_HIGH_RATE_THRESHOLD 192000u
+#endif
+
 /**
  * @brief Debug/testing mode - disables actual audio output
  * 
@@ -201,6 +239,28 @@ extern "C" {
 #endif
 #endif
 
+/**
+ * @brief Feed every outgoing buffer to the continuity checker
+ *
+ * When set to 1, the DMA IRQ passes each buffer (or NULL on underrun) to
+ * audio_verify_check_buffer() just before it is played. Intended for soak
+ * tests with the pico/audio_verify.h test signal.
+ */
+#ifndef PICO_AUDIO_I2S_VERIFY
+#define PICO_AUDIO_I2S_VERIFY 0
+#endif
+
+/**
+ * @brief GPIO raised while the latency probe marker is being played
+ *
+ * Only used when PICO_AUDIO_LATENCY is 1. The pin goes high at the start of
+ * the DMA transfer that carries the marker and low at the next one, so the
+ * edge can be compared against the DAC output on a scope. -1 disables it.
+ */
+#ifndef PICO_AUDIO_I2S_LATENCY_GPIO
+#define PICO_AUDIO_I2S_LATENCY_GPIO -1
+#endif
+
 /**
  * @brief Default GPIO pin for I2S data output (SDATA)
  * 
@@ -265,7 +325,9 @@ typedef struct audio_i2s_config {
      *  
      *  Used for the first half of double-buffering scheme.
      *  Must be different from dma_channel1.
-     *  Range: 0-11 (RP2040/RP2350)
+     *  Range: 0-11 (RP2040/RP2350), or HW_RESOURCE_AUTO (both channels) to
+     *  have free ones picked. Claimed by audio_i2s_setup() (which fails if
+     *  either is in use) and released by audio_i2s_end()
      */
     uint8_t dma_channel0;
     
@@ -273,7 +335,7 @@ typedef struct audio_i2s_config {
      *  
      *  Used for the second half of double-buffering scheme.
      *  Must be different from dma_channel0.
-     *  Range: 0-11 (RP2040/RP2350)
+     *  Range: 0-11 (RP2040/RP2350), or HW_RESOURCE_AUTO
      */
     uint8_t dma_channel1;
     
@@ -281,11 +343,37 @@ typedef struct audio_i2s_config {
      *  
      *  Each PIO instance has 4 state machines (0-3).
      *  The selected state machine must be available.
-     *  Range: 0-3
+     *  Range: 0-3, or HW_RESOURCE_AUTO for any free one
      */
     uint8_t pio_sm;
+
+    /** @brief Number of SDATA pins, from data_pin up (0 or 1: single line)
+     *
+     *  With 2 or 4 lines one state machine drives that many stereo DACs from
+     *  the same BCLK/LRCLK, so they are sample aligned by construction. The
+     *  output format then has 2 × data_line_count channels, stereo pair n
+     *  (channels 2n, 2n+1) on pin data_pin + n; the connection transposes the
+     *  frames to bit planes for `out pins, data_line_count`. The producer must
+     *  be in the output format (no F32), and passthru and render callback
+     *  modes are single line only.
+     */
+    uint8_t data_line_count;
 } audio_i2s_config_t;
 
+/**
+ * @brief Render callback for pull-style output
+ *
+ * Called by the driver to fill the next DMA-bound buffer directly.
+ *
+ * @param ctx       User context passed to audio_i2s_set_render_callback()
+ * @param out       Playback memory in the output format's native layout:
+ *                  S32 stereo is interleaved int32_t L/R (2 words per frame),
+ *                  S16 stereo is interleaved int16_t L/R (1 word per frame)
+ * @param frames    Number of frames to render
+ * @param frame_pos Stream position of the first frame in @p out
+ */
+typedef void (*audio_i2s_render_callback_t)(void *ctx, int32_t *out, uint frames, uint64_t frame_pos);
+
 /** @} */ // end of data_structures group
 
 // ============================================================================
@@ -346,6 +434,26 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *input_format,
                                      const audio_format_t *output_format,
                                      const audio_i2s_config_t *config);
 
+/**
+ * @brief Highest sample rate the I2S output can play at the current clk_sys
+ *
+ * The PIO program takes two instructions per bit (one per BCLK edge) and the
+ * PIO clock divider cannot go below 1, so the limit is
+ * clk_sys / (2 × 2 channels × bits per sample): 976 kHz for S32 and 1.95 MHz
+ * for S16 at 125 MHz. Each data line carries one stereo pair, so the limit
+ * does not depend on data_line_count. audio_i2s_setup() fails for a faster
+ * output format.
+ *
+ * Rates near the limit need a fractional divider unless clk_sys is a multiple
+ * of the PIO rate (e.g. 98.304 MHz or 196.608 MHz for 768 kHz S32); the
+ * resulting BCLK jitter is a whole clk_sys period, which the setup log warns
+ * about.
+ *
+ * @param pcm_format Output PCM format (S16 or S32)
+ * @return Maximum sample rate in Hz
+ */
+uint32_t audio_i2s_get_max_sample_freq(audio_pcm_format_t pcm_format);
+
 
 /**
  * @brief Shutdown I2S audio output system
@@ -468,6 +576,110 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
                             uint buffer_count, uint samples_per_buffer, 
                             audio_connection_t *connection);
 
+/**
+ * @brief Connect a producer through a caller-provided consumer pool
+ *
+ * Same as audio_i2s_connect_extra(), except that the consumer (DMA side) pool
+ * is not allocated here: @p consumer is typically a pool set up with
+ * audio_init_static_pool(), and @p connection a connection whose functions are
+ * bound to the exact formats at compile time. pico/audio_i2s_pipeline.h builds
+ * both from a constexpr description.
+ *
+ * A pre-bound @p connection does not follow sample rate changes of the
+ * producer format; the rate given here is the one played.
+ *
+ * @param producer   Audio buffer pool that generates audio data
+ * @param consumer   Consumer pool in the output format (pcm format and channels)
+ * @param connection Connection to use, or NULL for the default copy-on-take connection
+ * @return true if the connection was established
+ */
+bool audio_i2s_connect_with_pool(audio_buffer_pool_t *producer, audio_buffer_pool_t *consumer,
+                                 audio_connection_t *connection);
+
+/**
+ * @brief Connect a producer whose buffers the DMA plays directly
+ *
+ * No consumer buffers are allocated and nothing is copied: each buffer given
+ * to @p producer is played as is and returned to its free list afterwards.
+ * Segmented buffers (audio_buffer_set_segments()) are played one DMA transfer
+ * per fragment, so data scattered over SD sectors or USB packets needs no
+ * gather copy either.
+ *
+ * The producer format must already be the output format (no conversion, no
+ * mono to stereo), fragments must be word aligned and non-empty, and buffers
+ * are not split or merged, so very short buffers mean frequent DMA interrupts.
+ *
+ * @param producer Audio buffer pool in the output format
+ * @return true on success, false if the producer format differs from the output format
+ */
+bool audio_i2s_connect_passthru(audio_buffer_pool_t *producer);
+
+/**
+ * @brief Choose when a give-side connection hands partial buffers to the DMA
+ *
+ * Applies to the connection made by audio_i2s_connect_extra() with
+ * @p buffer_on_give set. Normally a consumer buffer is only queued once full;
+ * with AUDIO_FLUSH_EACH_GIVE every give_audio_buffer() queues what it has, and
+ * the DMA plays the shorter buffer as is. This replaces the compile time
+ * BLOCKING_GIVE_SYNCHRONIZE_BUFFERS (which still forces flushing when defined).
+ *
+ * The default (consumer take) connection needs no flushing: it already passes
+ * partially filled producer buffers straight through.
+ *
+ * @param policy AUDIO_FLUSH_WHEN_FULL (default) or AUDIO_FLUSH_EACH_GIVE
+ */
+void audio_i2s_set_flush_policy(audio_flush_policy_t policy);
+
+/**
+ * @brief Flush once at the end of the next give
+ *
+ * For latency sensitive events (e.g. a note-on transient) under
+ * AUDIO_FLUSH_WHEN_FULL: the next give_audio_buffer() queues its partial
+ * consumer buffer immediately, so the event reaches the DAC up to one buffer
+ * sooner. Safe to call from any core or IRQ.
+ */
+void audio_i2s_request_flush(void);
+
+
+/**
+ * @brief Render directly into playback memory instead of connecting a pool
+ *
+ * The driver owns one buffer per DMA channel. Each time a channel finishes,
+ * the callback renders that channel's next buffer while the other channel is
+ * playing, so there is no pool, no lock and no copy. Both buffers are rendered
+ * up front when output is enabled.
+ *
+ * Use instead of audio_i2s_connect(); pass NULL to release the buffers.
+ * Must be called after audio_i2s_setup() while output is disabled.
+ *
+ * @param callback          Render function, or NULL to leave render mode
+ * @param ctx               Passed through to @p callback
+ * @param frames_per_buffer Frames rendered per call (the output latency is
+ *                          about two buffers)
+ *
+ * @return true on success, false if the buffers could not be allocated
+ *
+ * @warning The callback runs in interrupt context (the deferred callback IRQ,
+ *          or the DMA IRQ when PICO_AUDIO_I2S_DEFER_CALLBACK is 0) and must
+ *          return well within the duration of one buffer. The weak
+ *          i2s_callback_func() is still called afterwards.
+ *
+ * @par Example:
+ * @code
+ * static void render(void *ctx, int32_t *out, uint frames, uint64_t frame_pos) {
+ *     for (uint i = 0; i < frames; i++) {
+ *         out[i * 2 + 0] = next_left();
+ *         out[i * 2 + 1] = next_right();
+ *     }
+ * }
+ *
+ * audio_i2s_setup(&format, &format, &config);
+ * audio_i2s_set_render_callback(render, NULL, 256);
+ * audio_i2s_set_enabled(true);
+ * @endcode
+ */
+bool audio_i2s_set_render_callback(audio_i2s_render_callback_t callback, void *ctx, uint frames_per_buffer);
+
 
 /**
  * @brief Enable or disable I2S audio output
@@ -498,6 +710,96 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
  */
 void audio_i2s_set_enabled(bool enabled);
 
+/**
+ * @brief Switch the output word length (S16 <-> S32) and producer without teardown
+ *
+ * For format changes between tracks: instead of audio_i2s_end() and a new
+ * setup (PIO program reload, pool reallocation), output stops at the end of
+ * the buffer that is playing, the state machine is paused and its bit count
+ * reloaded, the producer is reconnected and output resumes. The PIO program,
+ * GPIOs, DMA channels and consumer buffers are kept, so the gap is the rest
+ * of the playing buffer plus a few microseconds.
+ *
+ * Data still queued in the old format (a partly copied producer buffer,
+ * full consumer buffers of a buffer_on_give connection) is dropped. The
+ * consumer buffers keep their memory and hold size / frame size frames in
+ * the new format (half as many after switching S16 to S32).
+ *
+ * @param producer      Pool to play from now on (may be the current one);
+ *                      its format must be the output format or F32, with the
+ *                      same channel count and no faster than
+ *                      audio_i2s_get_max_sample_freq()
+ * @param output_format New output format (S16 or S32), kept by pointer as in
+ *                      audio_i2s_setup()
+ * @return false (nothing changed) for an unsupported format or a connection
+ *         other than audio_i2s_connect() / audio_i2s_connect_thru(NULL) /
+ *         audio_i2s_connect_extra(NULL) (passthru, render callback, custom
+ *         and static pipeline connections)
+ *
+ * Output that is disabled stays disabled, and output that is running resumes
+ * in the new format. If audio_i2s_set_enabled(true) has armed the transfers
+ * for another core that has not yet called audio_i2s_attach_irq(), they are
+ * re-armed with buffers in the new format and still start on attach.
+ *
+ * @note Call with output disabled, or from the core that services the DMA IRQ,
+ *       while nothing gives to the old producer pool. With a start pending,
+ *       call before the IRQ core can reach audio_i2s_attach_irq().
+ */
+bool audio_i2s_switch_format(audio_buffer_pool_t *producer, const audio_format_t *output_format);
+
+/**
+ * @brief Choose the core that services the audio DMA IRQ
+ *
+ * By default the DMA IRQ handler (and the deferred callback IRQ) is installed
+ * on whichever core calls audio_i2s_set_enabled(true). Choosing another core,
+ * e.g. core1 next to the renderer, keeps audio interrupts off the core that
+ * runs USB and UI, and buffers are handed back on the render core without any
+ * cross-core message.
+ *
+ * When the chosen core differs from the enabling core, audio_i2s_set_enabled(true)
+ * arms the transfers but does not start them; the chosen core must then call
+ * audio_i2s_attach_irq().
+ *
+ * @param core 0 or 1, or -1 for the core calling audio_i2s_set_enabled() (default)
+ *
+ * @note Call before audio_i2s_set_enabled(true). Not available together with
+ *       CORE1_PROCESS_I2S_CALLBACK when choosing core1.
+ */
+void audio_i2s_set_irq_core(int core);
+
+/**
+ * @brief Install the DMA IRQ on the calling core and start output
+ *
+ * Completes a pending audio_i2s_set_enabled(true) on the core chosen with
+ * audio_i2s_set_irq_core().
+ *
+ * @return true if output was started, false if no start was pending
+ *
+ * @par Example:
+ * @code
+ * // core0
+ * audio_i2s_set_irq_core(1);
+ * audio_i2s_set_enabled(true);     // arms DMA, does not start it
+ * multicore_launch_core1(core1_main);
+ *
+ * // core1
+ * void core1_main() {
+ *     audio_i2s_attach_irq();      // DMA IRQ now lands on core1
+ *     ...
+ * }
+ * @endcode
+ */
+bool audio_i2s_attach_irq(void);
+
+/**
+ * @brief Remove the DMA IRQ handler from the calling core
+ *
+ * audio_i2s_set_enabled(false) does this itself when called on the IRQ core.
+ * When disabling from the other core, DMA interrupts are masked at the DMA
+ * and the IRQ core should call this to release its NVIC handlers.
+ */
+void audio_i2s_detach_irq(void);
+
 /** @} */ // end of api_functions group
 
 #ifdef __cplusplus
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_AUDIO_I2S_PIPELINE_H
+#define _PICO_AUDIO_I2S_PIPELINE_H
+
+/** \file audio_i2s_pipeline.h
+ *  \defgroup pico_audio_i2s_pipeline pico_audio_i2s_pipeline
+ *
+ * Compile time I2S pipeline configuration (C++17)
+ *
+ * The whole pipeline is described by a struct of constexpr members:
+ *
+ * \code
+ * struct SynthPipelineConfig {
+ *     using input_fmt  = Stereo<FmtF32>;   // what the producer writes
+ *     using output_fmt = Stereo<FmtS32>;   // what the DMA plays
+ *     static constexpr uint32_t sample_freq = 48000;
+ *     static constexpr uint buffer_count = 3;            // producer pool
+ *     static constexpr uint buffer_frames = 64;
+ *     static constexpr uint consumer_buffer_count = 2;   // DMA side pool
+ *     static constexpr uint consumer_buffer_frames = 256;
+ *     static constexpr bool buffer_on_give = false;      // copy on give instead of on take
+ *     static constexpr audio_i2s_config_t i2s = {...};
+ * };
+ * using SynthPipeline = audio_i2s_pipeline<SynthPipelineConfig>;
+ *
+ * SynthPipeline::setup();
+ * SynthPipeline::connect();
+ * AudioBuffer<Stereo<FmtF32>> buffer = SynthPipeline::typed_producer().take();
+ * \endcode
+ *
+ * Unsupported formats and sizes fail to compile (static_assert) instead of
+ * asserting at run time. Pools, buffers and their storage are static objects
+ * (visible in the map file, nothing comes from the heap), and the connection
+ * is bound to the format conversion for exactly these formats, so the per
+ * buffer format switch in the driver is skipped. connect() only links the
+ * static buffers into the free lists.
+ *
+ * Because the connection is fixed, the sample rate cannot be changed at run
+ * time by changing the producer format.
+ */
+
+#include <type_traits>
+#include "pico/audio_i2s.h"
+#include "pico/audio_typed.h"
+
+#ifdef __cplusplus
+
+/** \brief Connection bound at compile time to one conversion (private) */
+template<bool BufferOnGive, typename ToFmt, typename FromFmt>
+struct audio_i2s_static_connection;
+
+template<typename ToFmt, typename FromFmt>
+struct audio_i2s_static_connection<false, ToFmt, FromFmt> {
+    static inline buffer_copying_on_consumer_take_connection connection = {
+            .core = {
+                    .producer_pool_take = producer_pool_take_buffer_default,
+                    .producer_pool_give = producer_pool_give_buffer_default,
+                    .consumer_pool_take = consumer_pool_take<ToFmt, FromFmt>,
+                    .consumer_pool_give = consumer_pool_give_buffer_default,
+            }
+    };
+};
+
+template<typename ToFmt, typename FromFmt>
+struct audio_i2s_static_connection<true, ToFmt, FromFmt> {
+    static inline producer_pool_blocking_give_connection connection = {
+            .core = {
+                    .producer_pool_take = producer_pool_take_buffer_default,
+                    .producer_pool_give = producer_pool_blocking_give<ToFmt, FromFmt>,
+                    .consumer_pool_take = consumer_pool_take_buffer_default,
+                    .consumer_pool_give = consumer_pool_give_buffer_default,
+            }
+    };
+};
+
+/** \brief Format of the DMA (consumer) buffers: the output format, or its bit planes for several data lines */
+template<typename OutputFmt, uint DataLines>
+struct audio_i2s_dma_fmt;
+
+template<typename Fmt, uint ChannelCount, uint DataLines>
+struct audio_i2s_dma_fmt<MultiChannelFmt<Fmt, ChannelCount>, DataLines> {
+    using type = typename std::conditional<DataLines == 1, MultiChannelFmt<Fmt, ChannelCount>,
+                                           I2SLinesFmt<Fmt, DataLines>>::type;
+};
+
+/** \brief Statically allocated I2S pipeline described by Config (see file description) */
+template<typename Config>
+struct audio_i2s_pipeline {
+    using input_fmt = typename Config::input_fmt;
+    using output_fmt = typename Config::output_fmt;
+
+    static constexpr audio_pcm_format_t input_pcm_format = audio_pcm_format_of<input_fmt>::value;
+    static constexpr audio_pcm_format_t output_pcm_format = audio_pcm_format_of<output_fmt>::value;
+
+    static constexpr uint data_line_count = Config::i2s.data_line_count ? Config::i2s.data_line_count : 1;
+
+    static_assert(data_line_count == 1 || data_line_count == 2 || data_line_count == 4,
+                  "1, 2 or 4 data lines");
+    static_assert(output_fmt::channel_count == AUDIO_CHANNEL_STEREO * data_line_count,
+                  "I2S output must be one stereo pair per data line");
+    static_assert(data_line_count == 1 || audio_pcm_format_of<input_fmt>::value ==
+                                          audio_pcm_format_of<output_fmt>::value,
+                  "several data lines need the producer in the output format");
+    static_assert(input_fmt::channel_count == output_fmt::channel_count,
+                  "producer and output channel counts must match");
+    static_assert(output_pcm_format == AUDIO_PCM_FORMAT_S16 || output_pcm_format == AUDIO_PCM_FORMAT_S32,
+                  "I2S output must be S16 or S32");
+    static_assert(input_pcm_format == output_pcm_format || input_pcm_format == AUDIO_PCM_FORMAT_F32,
+                  "producer format must be the output format or F32");
+    static_assert(Config::sample_freq > 0, "sample rate must be set");
+    static_assert(Config::buffer_count >= 1 && Config::buffer_frames >= 1, "producer pool is empty");
+    static_assert(Config::consumer_buffer_count >= 2,
+                  "the DMA needs two consumer buffers to ping-pong between");
+    static_assert(Config::consumer_buffer_frames >= 1, "consumer buffers are empty");
+    static_assert((Config::consumer_buffer_frames * output_fmt::frame_stride) % 4 == 0,
+                  "consumer buffers must be a whole number of DMA words");
+    static_assert(Config::i2s.dma_channel0 != Config::i2s.dma_channel1 ||
+                  Config::i2s.dma_channel0 == HW_RESOURCE_AUTO,
+                  "the two DMA channels must differ");
+
+    static constexpr audio_format_t input_format = {
+            .sample_freq = Config::sample_freq,
+            .pcm_format = input_pcm_format,
+            .channel_count = (audio_channel_t) input_fmt::channel_count,
+    };
+    static constexpr audio_format_t output_format = {
+            .sample_freq = Config::sample_freq,
+            .pcm_format = output_pcm_format,
+            .channel_count = (audio_channel_t) output_fmt::channel_count,
+    };
+
+    /** \brief Static memory used by the pipeline, in bytes */
+    static constexpr size_t storage_bytes =
+            Config::buffer_count * Config::buffer_frames * input_fmt::frame_stride +
+            Config::consumer_buffer_count * Config::consumer_buffer_frames * output_fmt::frame_stride;
+
+    /** \brief Configure the I2S hardware; see audio_i2s_setup() */
+    static const audio_format_t *setup() {
+        return audio_i2s_setup(&input_format, &output_format, &Config::i2s);
+    }
+
+    /** \brief Link the static pools and connect them to the I2S output */
+    static bool connect() {
+        audio_init_static_pool(&producer_pool, false, &producer_buffer_format, producer_buffers,
+                               producer_mem, producer_storage, Config::buffer_count, Config::buffer_frames);
+        audio_init_static_pool(&consumer_pool, true, &consumer_buffer_format, consumer_buffers,
+                               consumer_mem, consumer_storage, Config::consumer_buffer_count,
+                               Config::consumer_buffer_frames);
+        return audio_i2s_connect_with_pool(&producer_pool, &consumer_pool, &connection_type::connection.core);
+    }
+
+    /** \brief The producer pool to take/give buffers from/to */
+    static audio_buffer_pool_t *producer() {
+        return &producer_pool;
+    }
+
+    /** \brief The producer pool with its format as a type, see pico/audio_typed.h */
+    static AudioPool<input_fmt> typed_producer() {
+        return AudioPool<input_fmt>(&producer_pool);
+    }
+
+private:
+    using connection_type = audio_i2s_static_connection<Config::buffer_on_give,
+                                                        typename audio_i2s_dma_fmt<output_fmt, data_line_count>::type,
+                                                        input_fmt>;
+
+    static inline audio_buffer_format_t producer_buffer_format = {
+            .format = &input_format,
+            .sample_stride = input_fmt::frame_stride,
+    };
+    static inline audio_buffer_format_t consumer_buffer_format = {
+            .format = &output_format,
+            .sample_stride = output_fmt::frame_stride,
+    };
+
+    static inline audio_buffer_pool_t producer_pool;
+    static inline audio_buffer_t producer_buffers[Config::buffer_count];
+    static inline mem_buffer_t producer_mem[Config::buffer_count];
+    alignas(4) static inline uint8_t producer_storage[Config::buffer_count * Config::buffer_frames *
+                                                      input_fmt::frame_stride];
+
+    static inline audio_buffer_pool_t consumer_pool;
+    static inline audio_buffer_t consumer_buffers[Config::consumer_buffer_count];
+    static inline mem_buffer_t consumer_mem[Config::consumer_buffer_count];
+    alignas(4) static inline uint8_t consumer_storage[Config::consumer_buffer_count *
+                                                      Config::consumer_buffer_frames * output_fmt::frame_stride];
+};
+
+#endif
+#endif //_PICO_AUDIO_I2S_PIPELINE_H
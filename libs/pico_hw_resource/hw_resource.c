@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file hw_resource.c
+ * @brief PIO and DMA resource sharing between drivers
+ */
+
+#include "pico/hw_resource.h"
+#include "pico/mutex.h"
+#include "hardware/claim.h"
+#include "hardware/dma.h"
+
+static struct {
+    PIO pio;
+    const pio_program_t *program;
+    uint8_t offset;
+    uint8_t users;
+} programs[PICO_HW_RESOURCE_MAX_PROGRAMS];
+
+// shared handlers added through this library, per core and IRQ line
+static uint8_t irq_users[NUM_CORES][NUM_IRQS];
+
+// Held across "is it claimed?" and the claim of a specific state machine or
+// DMA channel. The SDK claim functions take hw_claim_lock() themselves, so it
+// cannot be held around them.
+auto_init_mutex(claim_mutex);
+
+int hw_resource_add_pio_program(PIO pio, const pio_program_t *program) {
+    int offset = -1;
+    uint32_t save = hw_claim_lock();
+    int free_slot = -1;
+    for (int i = 0; i < PICO_HW_RESOURCE_MAX_PROGRAMS; i++) {
+        if (programs[i].users && programs[i].pio == pio && programs[i].program == program) {
+            programs[i].users++;
+            offset = programs[i].offset;
+            break;
+        }
+        if (!programs[i].users && free_slot < 0) free_slot = i;
+    }
+    if (offset < 0 && free_slot >= 0 && pio_can_add_program(pio, program)) {
+        offset = (int) pio_add_program(pio, program);
+        programs[free_slot].pio = pio;
+        programs[free_slot].program = program;
+        programs[free_slot].offset = (uint8_t) offset;
+        programs[free_slot].users = 1;
+    }
+    hw_claim_unlock(save);
+    return offset;
+}
+
+void hw_resource_remove_pio_program(PIO pio, const pio_program_t *program) {
+    uint32_t save = hw_claim_lock();
+    for (int i = 0; i < PICO_HW_RESOURCE_MAX_PROGRAMS; i++) {
+        if (programs[i].users && programs[i].pio == pio && programs[i].program == program) {
+            if (!--programs[i].users) {
+                pio_remove_program(pio, program, programs[i].offset);
+            }
+            break;
+        }
+    }
+    hw_claim_unlock(save);
+}
+
+int hw_resource_claim_sm(PIO pio, uint sm) {
+    if (sm == HW_RESOURCE_AUTO) return pio_claim_unused_sm(pio, false);
+    mutex_enter_blocking(&claim_mutex);
+    bool claimed = pio_sm_is_claimed(pio, sm);
+    if (!claimed) pio_sm_claim(pio, sm);
+    mutex_exit(&claim_mutex);
+    return claimed ? -1 : (int) sm;
+}
+
+int hw_resource_claim_dma_channel(uint channel) {
+    if (channel == HW_RESOURCE_AUTO) return dma_claim_unused_channel(false);
+    mutex_enter_blocking(&claim_mutex);
+    bool claimed = dma_channel_is_claimed(channel);
+    if (!claimed) dma_channel_claim(channel);
+    mutex_exit(&claim_mutex);
+    return claimed ? -1 : (int) channel;
+}
+
+void hw_resource_add_shared_irq_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    irq_add_shared_handler(num, handler, order_priority);
+    uint32_t save = hw_claim_lock();
+    irq_users[get_core_num()][num]++;
+    hw_claim_unlock(save);
+    irq_set_enabled(num, true);
+}
+
+void hw_resource_remove_shared_irq_handler(uint num, irq_handler_t handler) {
+    uint32_t save = hw_claim_lock();
+    uint8_t *users = &irq_users[get_core_num()][num];
+    bool last = *users && !--*users;
+    hw_claim_unlock(save);
+    if (last) irq_set_enabled(num, false);
+    irq_remove_handler(num, handler);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_HW_RESOURCE_H
+#define _PICO_HW_RESOURCE_H
+
+#include "pico.h"
+#include "hardware/pio.h"
+#include "hardware/irq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file hw_resource.h
+ *  \defgroup pico_hw_resource pico_hw_resource
+ *
+ * PIO and DMA resource sharing between drivers
+ *
+ * The SDK already arbitrates state machines and DMA channels with claim bits;
+ * what it does not share is PIO instruction memory and IRQ lines. Drivers that
+ * each load their own copy of a program, wipe the whole instruction memory on
+ * exit, or switch a shared IRQ line off when they are done break any other
+ * driver on the same chip. This library adds:
+ *
+ * - reference counted PIO programs: a program already loaded on a PIO is
+ *   reused rather than loaded again, and only removed by its last user
+ * - state machine and DMA channel claims that pick a free one when asked for
+ *   HW_RESOURCE_AUTO
+ * - shared IRQ handlers that keep the IRQ line enabled while any handler
+ *   registered through this library remains on it
+ *
+ * All functions are safe to call from either core (they use the SDK hardware
+ * claim lock, and a mutex around the claim of a specific state machine or DMA
+ * channel) but not from IRQ handlers. A specific claim made through this
+ * library is only atomic against other users of it: code calling
+ * pio_sm_claim() / dma_channel_claim() directly on the same resource can
+ * still make one of the two panic.
+ */
+
+/** \brief Pass as a state machine or DMA channel number to have a free one chosen
+ *  \ingroup pico_hw_resource
+ */
+#define HW_RESOURCE_AUTO 0xff
+
+// PICO_CONFIG: PICO_HW_RESOURCE_MAX_PROGRAMS, Maximum number of distinct PIO programs tracked at once, min=1, default=8, group=pico_hw_resource
+#ifndef PICO_HW_RESOURCE_MAX_PROGRAMS
+#define PICO_HW_RESOURCE_MAX_PROGRAMS 8
+#endif
+
+/*! \brief Load a program, or share the copy already loaded on that PIO
+ *  \ingroup pico_hw_resource
+ *
+ * \param pio PIO instance
+ * \param program Program to load; identified by address, so all users must pass the same pio_program_t
+ * \return Instruction memory offset, or -1 if there is no room
+ */
+int hw_resource_add_pio_program(PIO pio, const pio_program_t *program);
+
+/*! \brief Release a program added with hw_resource_add_pio_program()
+ *  \ingroup pico_hw_resource
+ *
+ * The instructions are removed once the last user has released it; other
+ * programs on the PIO are left alone.
+ */
+void hw_resource_remove_pio_program(PIO pio, const pio_program_t *program);
+
+/*! \brief Claim a state machine
+ *  \ingroup pico_hw_resource
+ *
+ * \param pio PIO instance
+ * \param sm State machine number, or HW_RESOURCE_AUTO for any free one
+ * \return Claimed state machine, or -1 if it (or every one) is in use
+ */
+int hw_resource_claim_sm(PIO pio, uint sm);
+
+/*! \brief Claim a DMA channel
+ *  \ingroup pico_hw_resource
+ *
+ * \param channel Channel number, or HW_RESOURCE_AUTO for any free one
+ * \return Claimed channel, or -1 if it (or every one) is in use
+ */
+int hw_resource_claim_dma_channel(uint channel);
+
+/*! \brief Add a shared IRQ handler on the calling core and enable the IRQ line
+ *  \ingroup pico_hw_resource
+ *
+ * \param num IRQ number
+ * \param handler Handler to add
+ * \param order_priority As for irq_add_shared_handler()
+ */
+void hw_resource_add_shared_irq_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+
+/*! \brief Remove a handler added with hw_resource_add_shared_irq_handler()
+ *  \ingroup pico_hw_resource
+ *
+ * The IRQ line is disabled on the calling core only when no handler added
+ * through this library remains on it.
+ */
+void hw_resource_remove_shared_irq_handler(uint num, irq_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_PICO_HW_RESOURCE_H
@@ -0,0 +1,144 @@
+/**
+ * @file block_analysis.h
+ * @brief Cross FM Noise Synthesizer - ブロック単位の信号解析
+ *
+ * オーディオブロックを1回なめて、制御判断に使う値を求める軽量な解析ノードです。
+ * 結果はブロック単位で更新されるので、判断（ランダム復帰など）もブロックに1回で済みます。
+ *
+ * - EnvelopeFollower: ブロックのRMS・ピークと、アタック/リリースで平滑化したエンベロープ
+ * - SilenceDetector: 2つの閾値と保持ブロック数によるヒステリシス付き無音検出
+ * - ZeroCrossingPitch: ゼロ交差数からの周波数推定（ブロックをまたいで符号を保持）
+ */
+
+#ifndef BLOCK_ANALYSIS_H
+#define BLOCK_ANALYSIS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+
+/** RMS・ピークのエンベロープフォロワー */
+class EnvelopeFollower
+{
+  public:
+    EnvelopeFollower() {}
+    ~EnvelopeFollower() {}
+
+    /** 初期化
+        \param sample_rate - サンプリング周波数
+        \param attack_ms - 上昇の時定数（ms）
+        \param release_ms - 下降の時定数（ms）
+    */
+    void Init(float sample_rate, float attack_ms, float release_ms);
+
+    /** ブロックを解析
+        \param in - 入力
+        \param size - サンプル数
+    */
+    void Process(const float *in, uint32_t size);
+
+    /** 直前のブロックのRMS */
+    float GetBlockRms() const { return block_rms_; }
+
+    /** 直前のブロックのピーク（絶対値の最大） */
+    float GetBlockPeak() const { return block_peak_; }
+
+    /** 平滑化したRMS */
+    float GetRms() const { return rms_; }
+
+    /** 平滑化したピーク */
+    float GetPeak() const { return peak_; }
+
+  private:
+    void UpdateCoefficients(uint32_t size);
+
+    float    sample_rate_;
+    float    attack_ms_;
+    float    release_ms_;
+    uint32_t coef_size_; // 係数を計算したブロックサイズ
+    float    attack_coef_;
+    float    release_coef_;
+    float    block_rms_;
+    float    block_peak_;
+    float    rms_;
+    float    peak_;
+};
+
+/** ヒステリシス付き無音検出 */
+class SilenceDetector
+{
+  public:
+    struct Config
+    {
+        float    enter_level = 0.001f; ///< これを下回り続けたら無音（約 -60dBFS）
+        float    exit_level  = 0.004f; ///< これを超えたら無音を解除（約 -48dBFS）
+        uint32_t hold_blocks = 8;      ///< 無音と判定するまでの連続ブロック数
+    };
+
+    SilenceDetector() {}
+    ~SilenceDetector() {}
+
+    /** 初期化
+        \param config - 検出設定
+    */
+    void Init(const Config &config);
+
+    /** ブロックのレベルで状態を更新
+        \param level - ブロックのレベル（RMSなど）
+        \return このブロックで無音になった（立ち上がり）なら true
+    */
+    bool Update(float level);
+
+    /** 無音状態か */
+    bool IsSilent() const { return silent_; }
+
+    /** 判定をやり直す（無音状態を解除し、保持ブロック数を数え直す） */
+    void Reset()
+    {
+        silent_       = false;
+        quiet_blocks_ = 0;
+    }
+
+  private:
+    Config   config_;
+    bool     silent_;
+    uint32_t quiet_blocks_;
+};
+
+/** ゼロ交差による周波数推定 */
+class ZeroCrossingPitch
+{
+  public:
+    ZeroCrossingPitch() {}
+    ~ZeroCrossingPitch() {}
+
+    /** 初期化
+        \param sample_rate - サンプリング周波数
+        \param threshold - 符号の切り替えに必要な振幅（ノイズでの余分な交差を防ぐ）
+        \param smoothing - 推定値の平滑化係数（指数移動平均、1 = 平滑化なし）
+    */
+    void Init(float sample_rate, float threshold = 0.01f, float smoothing = 0.25f);
+
+    /** ブロックを解析
+        \param in - 入力
+        \param size - サンプル数
+    */
+    void Process(const float *in, uint32_t size);
+
+    /** 推定周波数（Hz、正の向きのゼロ交差の頻度） */
+    float GetFrequency() const { return frequency_; }
+
+    /** 直前のブロックのゼロ交差数（両方向） */
+    uint32_t GetBlockCrossings() const { return block_crossings_; }
+
+  private:
+    float    sample_rate_;
+    float    threshold_;
+    float    smoothing_;
+    bool     positive_; // ブロックをまたいで保持する現在の符号
+    uint32_t block_crossings_;
+    float    frequency_;
+};
+
+#endif
+#endif // BLOCK_ANALYSIS_H
@@ -0,0 +1,85 @@
+/**
+ * @file cross_fm_kernel.h
+ * @brief Cross FM Noise Synthesizer - 相互位相変調デュアルオシレーター（ブロック処理）
+ *
+ * DaisySP Fm2と同じ構成（キャリア + モジュレーター）のFM音源2つが、
+ * 互いの出力で周波数・インデックス・レシオを変調し合うクロスモジュレーションを
+ * 1つのブロックループの中で直接計算します。
+ *
+ * - 位相は32bit固定小数点（1周期 = 2^32）で、周波数が負になってもそのまま逆回転する（スルーゼロFM）
+ * - 正弦波は線形補間付きテーブル参照（sinf呼び出しなし）
+ * - setterを介した位相増分の再計算をせず、変調値から直接位相増分を求める
+ * - 暴走防止: 位相増分をナイキスト以内、1サンプルの位相オフセットを max_phase_offset 以内に制限
+ */
+
+#ifndef CROSS_FM_KERNEL_H
+#define CROSS_FM_KERNEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+
+/** 相互位相変調デュアルオシレーター */
+class CrossFmKernel
+{
+  public:
+    /** 各FM音源の変調の深さ（相手の出力 ±1 に対する値） */
+    struct VoiceParams
+    {
+        float freq_scale;  ///< 周波数（Hz）
+        float index_scale; ///< インデックス（Fm2::SetIndex と同じ単位）
+        float ratio_scale; ///< モジュレーター周波数のレシオ
+        bool  enabled;     ///< false なら出力0（位相も進めない）
+    };
+
+    CrossFmKernel() {}
+    ~CrossFmKernel() {}
+
+    /** 初期化
+        \param sample_rate - サンプリング周波数
+    */
+    void Init(float sample_rate);
+
+    /** 変調の深さを設定（ブロック単位）
+        \param voice - 0 または 1
+        \param params - 変調の深さ
+    */
+    void SetVoice(int voice, const VoiceParams &params) { voice_[voice].params = params; }
+
+    /** 現在の周波数・インデックス・レシオを直接設定（次の変調更新まで保持）
+        \param voice - 0 または 1
+    */
+    void Reseed(int voice, float freq, float index, float ratio);
+
+    /** 1サンプルあたりの位相オフセットの上限（周期単位、既定値は 4 = インデックス20相当） */
+    void SetMaxPhaseOffset(float cycles) { max_phase_offset_ = cycles; }
+
+    /** ブロック処理
+        \param out0 - FM音源0の出力先
+        \param out1 - FM音源1の出力先
+        \param size - サンプル数
+        \param update_mask - 相互変調を (i & update_mask) == 0 のサンプルで更新（1 = 2サンプルごと）
+    */
+    void Process(float *out0, float *out1, uint32_t size, uint32_t update_mask);
+
+  private:
+    struct Voice
+    {
+        VoiceParams params;
+        uint32_t    car_phase;
+        uint32_t    mod_phase;
+        float       freq;  // 現在の値（相互変調で更新）
+        float       index; // Fm2と同じく 0.2 倍済み
+        float       ratio;
+    };
+
+    float Render(Voice &voice) const;
+    void  Update(Voice &voice, float mod) const;
+
+    Voice voice_[2];
+    float phase_per_hz_;     // 1Hzあたりの位相増分（周期単位）
+    float max_phase_offset_;
+};
+
+#endif
+#endif // CROSS_FM_KERNEL_H
@@ -0,0 +1,78 @@
+/**
+ * @file param_store.h
+ * @brief Cross FM Noise Synthesizer - コア間パラメーター受け渡し（シーケンスロック）
+ *
+ * UI/制御コア（Core0）が書き込み、オーディオコア（Core1）がブロック先頭で読み出す
+ * 単一ライター用のシーケンスロックです。
+ *
+ * - 書き込み側はシーケンス番号を奇数にしてからデータをコピーし、偶数に戻す
+ * - 読み出し側はシーケンス番号が偶数かつコピー前後で一致した場合のみ採用する
+ *
+ * ロックも排他命令（LDREX/STREX）も使わないので、RP2040（Cortex-M0+）でも
+ * RP2350（Cortex-M33 / Hazard3）でも同じコードで動作します。
+ * 読み出しは回数制限付きで、書き込み中だった場合は前回の値を使い続けます
+ * （オーディオコアが待たされることはありません）。
+ */
+
+#ifndef PARAM_STORE_H
+#define PARAM_STORE_H
+
+#include <stdint.h>
+#include <string.h>
+#include "hardware/sync.h"
+
+#ifdef __cplusplus
+
+/** シーケンスロック方式のパラメーターストア（単一ライター / 単一リーダー） */
+template <typename T>
+class ParamStore
+{
+  public:
+    ParamStore() : sequence_(0) {}
+
+    /** 新しいスナップショットを公開（書き込み側コアのみ）
+        \param value - 公開する値
+    */
+    void Publish(const T &value)
+    {
+        const uint32_t seq = sequence_;
+        sequence_ = seq + 1; // 奇数 = 書き込み中
+        __mem_fence_release();
+        memcpy((void *)&value_, &value, sizeof(T));
+        __mem_fence_release();
+        sequence_ = seq + 2;
+    }
+
+    /** 前回の読み出し以降に更新されていれば最新のスナップショットを取得
+        \param out - 取得先（更新がない場合・取得できなかった場合は変更しない）
+        \param last_sequence - 前回取得したシーケンス番号（呼び出し側で保持）
+        \return 新しいスナップショットを取得した場合 true
+    */
+    bool ReadIfChanged(T &out, uint32_t &last_sequence) const
+    {
+        for (int retry = 0; retry < kMaxRetries; retry++) {
+            const uint32_t seq = sequence_;
+            if (seq == last_sequence) return false;
+            if (seq & 1) continue; // 書き込み中
+            __mem_fence_acquire();
+            T snapshot;
+            memcpy(&snapshot, (const void *)&value_, sizeof(T));
+            __mem_fence_acquire();
+            if (sequence_ == seq) {
+                out = snapshot;
+                last_sequence = seq;
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    static constexpr int kMaxRetries = 4;
+
+    volatile uint32_t sequence_;
+    volatile T value_;
+};
+
+#endif
+#endif // PARAM_STORE_H
@@ -0,0 +1,80 @@
+/**
+ * @file quality_scheduler.h
+ * @brief Cross FM Noise Synthesizer - 負荷適応型の品質スケジューラ
+ *
+ * Core1のブロック処理時間をデッドライン（1ブロックの再生時間）と比較し、
+ * 処理が間に合わなくなる前に重い処理を段階的に間引きます。
+ * ヘッドルームが戻ったら、一定ブロック数の猶予をおいて元の品質に戻します。
+ *
+ * - 劣化: 直近ブロックの負荷 または 平滑化負荷 が degrade_threshold を超えたら即座に1段下げる
+ * - 復帰: 平滑化負荷が restore_threshold 未満の状態が restore_blocks ブロック続いたら1段上げる
+ *
+ * 2つの閾値と復帰待ちブロック数がヒステリシスになり、段階の往復（バタつき）を防ぎます。
+ */
+
+#ifndef QUALITY_SCHEDULER_H
+#define QUALITY_SCHEDULER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+
+/** 品質スケジューラ */
+class QualityScheduler
+{
+  public:
+    struct Config
+    {
+        uint32_t deadline_us;      ///< 1ブロックの再生時間（処理時間の上限）
+        int      max_level;        ///< 最も低い品質段階（0 = 最高品質）
+        float    degrade_threshold = 0.80f; ///< これを超えたら品質を下げる（デッドライン比）
+        float    restore_threshold = 0.55f; ///< これを下回り続けたら品質を戻す（デッドライン比）
+        uint32_t restore_blocks    = 375;   ///< 復帰までに必要な連続ブロック数
+        float    smoothing         = 0.125f; ///< 平滑化負荷の係数（指数移動平均）
+    };
+
+    QualityScheduler() {}
+    ~QualityScheduler() {}
+
+    /** 初期化
+        \param config - スケジューラ設定
+    */
+    void Init(const Config &config);
+
+    /** ブロック処理の開始時に呼ぶ */
+    void BeginBlock();
+
+    /** ブロック処理の終了時に呼ぶ
+        \return 次のブロックで使う品質段階
+    */
+    int EndBlock();
+
+    /** 現在の品質段階（0 = 最高品質） */
+    int GetLevel() const { return level_; }
+
+    /** 平滑化負荷（デッドライン比） */
+    float GetLoad() const { return load_; }
+
+    /** 計測した最大ブロック処理時間（us） */
+    uint32_t GetPeakUs() const { return peak_us_; }
+
+    /** 品質を下げた回数 */
+    uint32_t GetDegradeCount() const { return degrade_count_; }
+
+    /** デッドラインを超えたブロック数 */
+    uint32_t GetMissCount() const { return miss_count_; }
+
+  private:
+    Config   config_;
+    int      level_;
+    float    load_;
+    uint32_t start_us_;
+    uint32_t calm_blocks_;
+    uint32_t settle_blocks_;
+    uint32_t peak_us_;
+    uint32_t degrade_count_;
+    uint32_t miss_count_;
+};
+
+#endif
+#endif // QUALITY_SCHEDULER_H
@@ -44,6 +44,18 @@ typedef enum {
 
 // ===== データ構造 =====
 
+#define SYNTH_KNOB_COUNT        8
+
+/**
+ * @brief オーディオコアへ渡すパラメータースナップショット
+ *
+ * 制御コアが ParamStore（param_store.h）で公開し、オーディオコアがブロック先頭で取得する。
+ */
+typedef struct {
+    uint16_t knobs[SYNTH_KNOB_COUNT]; // ノブ値（0-1023）
+    bool audio_enabled;               // 音声生成の有効/無効
+} SynthParams;
+
 /**
  * @brief FMオペレーター
  */
@@ -0,0 +1,181 @@
+/**
+ * @file waveshaper.h
+ * @brief Cross FM Noise Synthesizer - テーブル参照型ウェーブシェーパー
+ *
+ * ドライブ量ごとの伝達カーブ（スライス）をあらかじめテーブルにしておき、
+ * 入力方向とドライブ方向の2次元線形補間で出力を求めます。
+ * 1サンプルあたりの処理はテーブル参照4回と乗算数回だけで、
+ * ドライブをブロック内で直線的に動かしても係数の再計算は発生しません。
+ *
+ * - Waveshaper<float>: float入出力（-1 ～ 1）
+ * - Waveshaper<int32_t>: Q31入出力（テーブルもQ31、整数演算のみ）
+ * - カーブは関数（WaveshaperCurve）から生成するか、テーブルを直接読み込む
+ */
+
+#ifndef WAVESHAPER_H
+#define WAVESHAPER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+
+/** 伝達カーブ: ドライブ（0 ～ 1）と入力（-1 ～ 1）から出力（-1 ～ 1） */
+typedef float (*WaveshaperCurve)(float drive, float x);
+
+/** OverdriveCurve が使うドライブの上限（DaisySP のドライブ 1.0 の不連続点を避ける） */
+constexpr float kOverdriveMaxDrive = 0.999f;
+
+/** DaisySP Overdrive と同じ伝達カーブ（プリゲイン → SoftClip → ポストゲイン）
+    ドライブは kOverdriveMaxDrive で頭打ち（1.0 ちょうどでのポストゲインの跳ね上がりは再現しない）
+*/
+float OverdriveCurve(float drive, float x);
+
+/** テーブル参照型ウェーブシェーパー（T = float または int32_t（Q31）） */
+template <typename T>
+class Waveshaper
+{
+  public:
+    static constexpr int kInputPoints = 257; ///< 1スライスの点数（入力 -1 ～ 1 を256区間）
+    static constexpr int kMaxSlices   = 17;  ///< ドライブ方向のスライス数の上限
+
+    Waveshaper() {}
+    ~Waveshaper() {}
+
+    /** 初期化（OverdriveCurve、ドライブ0.5） */
+    void Init()
+    {
+        LoadCurve(OverdriveCurve, kMaxSlices);
+        drive_ = target_ = 0.5f;
+    }
+
+    /** 関数からテーブルを生成
+        \param curve - 伝達カーブ
+        \param slices - ドライブ方向のスライス数（2 ～ kMaxSlices、ドライブ 0 ～ 1 を等分）
+    */
+    void LoadCurve(WaveshaperCurve curve, int slices)
+    {
+        slices_ = Clamp(slices, 2, kMaxSlices);
+        for (int s = 0; s < slices_; s++) {
+            const float drive = (float)s / (float)(slices_ - 1);
+            for (int i = 0; i < kInputPoints; i++) {
+                const float x = 2.0f * (float)i / (float)(kInputPoints - 1) - 1.0f;
+                table_[s * kInputPoints + i] = FromFloat(curve(drive, x));
+            }
+        }
+    }
+
+    /** テーブルを直接読み込む
+        \param table - slices × kInputPoints の値（スライス順、各スライスは入力 -1 → 1）
+        \param slices - ドライブ方向のスライス数（2 ～ kMaxSlices）
+    */
+    void LoadTable(const T *table, int slices)
+    {
+        slices_ = Clamp(slices, 2, kMaxSlices);
+        for (int i = 0; i < slices_ * kInputPoints; i++) {
+            table_[i] = table[i];
+        }
+    }
+
+    /** ドライブ量を設定（0 ～ 1、ProcessBlock() ではブロック内で直線的に移行） */
+    void SetDrive(float drive) { target_ = drive < 0.0f ? 0.0f : (drive > 1.0f ? 1.0f : drive); }
+
+    /** 1サンプル処理（ドライブは設定値そのもの） */
+    T Process(T in)
+    {
+        drive_ = target_;
+        int   slice;
+        float frac;
+        SlicePosition(drive_, slice, frac);
+        return Shape(in, slice, frac);
+    }
+
+    /** ブロック処理（その場で変換）
+        \param buf - 入出力バッファ
+        \param size - サンプル数
+    */
+    void ProcessBlock(T *buf, size_t size)
+    {
+        if (!size) return;
+        const float step = (target_ - drive_) / (float)size;
+        float drive = drive_;
+        for (size_t i = 0; i < size; i++) {
+            drive += step;
+            int   slice;
+            float frac;
+            SlicePosition(drive, slice, frac);
+            buf[i] = Shape(buf[i], slice, frac);
+        }
+        drive_ = target_;
+    }
+
+  private:
+    static int Clamp(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+    void SlicePosition(float drive, int &slice, float &frac) const
+    {
+        const float pos = drive * (float)(slices_ - 1);
+        slice = (int)pos;
+        if (slice > slices_ - 2) slice = slices_ - 2;
+        frac = pos - (float)slice;
+    }
+
+    static T    FromFloat(float v);
+    T           Shape(T in, int slice, float drive_frac) const;
+
+    T     table_[kMaxSlices * kInputPoints];
+    int   slices_ = 2;
+    float drive_  = 0.0f; // 直前のブロック終端のドライブ
+    float target_ = 0.0f;
+};
+
+// ---- float ----
+
+template <>
+inline float Waveshaper<float>::FromFloat(float v)
+{
+    return v;
+}
+
+template <>
+inline float Waveshaper<float>::Shape(float in, int slice, float drive_frac) const
+{
+    const float x   = in < -1.0f ? -1.0f : (in > 1.0f ? 1.0f : in);
+    const float pos = (x + 1.0f) * (0.5f * (float)(kInputPoints - 1));
+    int         i   = (int)pos;
+    if (i > kInputPoints - 2) i = kInputPoints - 2;
+    const float  fx = pos - (float)i;
+    const float *a  = &table_[slice * kInputPoints + i];
+    const float *b  = a + kInputPoints;
+    const float  ya = a[0] + (a[1] - a[0]) * fx;
+    const float  yb = b[0] + (b[1] - b[0]) * fx;
+    return ya + (yb - ya) * drive_frac;
+}
+
+// ---- Q31 ----
+
+template <>
+inline int32_t Waveshaper<int32_t>::FromFloat(float v)
+{
+    if (v >= 1.0f) return INT32_MAX;
+    if (v <= -1.0f) return INT32_MIN;
+    return (int32_t)(v * 2147483648.0f);
+}
+
+template <>
+inline int32_t Waveshaper<int32_t>::Shape(int32_t in, int slice, float drive_frac) const
+{
+    // 入力の上位8bitが区間、続く16bitが区間内の位置（256区間）
+    const uint32_t u  = (uint32_t)in ^ 0x80000000u;
+    const uint32_t i  = u >> 24;
+    const int64_t  fx = (u >> 8) & 0xffffu;
+    const int64_t  fd = (int64_t)(drive_frac * 65536.0f);
+    const int32_t *a  = &table_[slice * kInputPoints + i];
+    const int32_t *b  = a + kInputPoints;
+    const int64_t  ya = a[0] + ((((int64_t)a[1] - a[0]) * fx) >> 16);
+    const int64_t  yb = b[0] + ((((int64_t)b[1] - b[0]) * fx) >> 16);
+    return (int32_t)(ya + (((yb - ya) * fd) >> 16));
+}
+
+#endif
+#endif // WAVESHAPER_H
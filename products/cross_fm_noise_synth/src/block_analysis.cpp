@@ -0,0 +1,109 @@
+/**
+ * @file block_analysis.cpp
+ * @brief Cross FM Noise Synthesizer - ブロック単位の信号解析実装
+ */
+
+#include "../include/block_analysis.h"
+#include <cmath>
+
+// ---- EnvelopeFollower ----
+
+void EnvelopeFollower::Init(float sample_rate, float attack_ms, float release_ms)
+{
+    sample_rate_  = sample_rate;
+    attack_ms_    = attack_ms;
+    release_ms_   = release_ms;
+    coef_size_    = 0;
+    attack_coef_  = 1.0f;
+    release_coef_ = 1.0f;
+    block_rms_    = 0.0f;
+    block_peak_   = 0.0f;
+    rms_          = 0.0f;
+    peak_         = 0.0f;
+}
+
+void EnvelopeFollower::UpdateCoefficients(uint32_t size)
+{
+    // 1ブロック分の時間で時定数に追従する係数（ブロックサイズが変わったときだけ計算）
+    const float block_ms = 1000.0f * (float)size / sample_rate_;
+    attack_coef_  = attack_ms_ > 0.0f ? 1.0f - expf(-block_ms / attack_ms_) : 1.0f;
+    release_coef_ = release_ms_ > 0.0f ? 1.0f - expf(-block_ms / release_ms_) : 1.0f;
+    coef_size_    = size;
+}
+
+void EnvelopeFollower::Process(const float *in, uint32_t size)
+{
+    if (!size) return;
+    if (size != coef_size_) UpdateCoefficients(size);
+
+    float sum  = 0.0f;
+    float peak = 0.0f;
+    for (uint32_t i = 0; i < size; i++) {
+        const float x = in[i];
+        sum += x * x;
+        const float a = fabsf(x);
+        if (a > peak) peak = a;
+    }
+    block_rms_  = sqrtf(sum / (float)size);
+    block_peak_ = peak;
+
+    rms_ += (block_rms_ - rms_) * (block_rms_ > rms_ ? attack_coef_ : release_coef_);
+    peak_ += (block_peak_ - peak_) * (block_peak_ > peak_ ? attack_coef_ : release_coef_);
+}
+
+// ---- SilenceDetector ----
+
+void SilenceDetector::Init(const Config &config)
+{
+    config_ = config;
+    Reset();
+}
+
+bool SilenceDetector::Update(float level)
+{
+    if (silent_) {
+        if (level > config_.exit_level) Reset();
+        return false;
+    }
+    if (level >= config_.enter_level) {
+        quiet_blocks_ = 0;
+        return false;
+    }
+    if (++quiet_blocks_ < config_.hold_blocks) return false;
+    silent_ = true;
+    return true;
+}
+
+// ---- ZeroCrossingPitch ----
+
+void ZeroCrossingPitch::Init(float sample_rate, float threshold, float smoothing)
+{
+    sample_rate_     = sample_rate;
+    threshold_       = threshold;
+    smoothing_       = smoothing;
+    positive_        = false;
+    block_crossings_ = 0;
+    frequency_       = 0.0f;
+}
+
+void ZeroCrossingPitch::Process(const float *in, uint32_t size)
+{
+    if (!size) return;
+
+    // ±threshold のシュミットトリガーで符号を決め、切り替わった回数を数える
+    bool     positive  = positive_;
+    uint32_t crossings = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        const float x = in[i];
+        if (positive ? x < -threshold_ : x > threshold_) {
+            positive = !positive;
+            crossings++;
+        }
+    }
+    positive_        = positive;
+    block_crossings_ = crossings;
+
+    // 1周期で2回交差する
+    const float block_frequency = (float)crossings * sample_rate_ / (2.0f * (float)size);
+    frequency_ += (block_frequency - frequency_) * smoothing_;
+}
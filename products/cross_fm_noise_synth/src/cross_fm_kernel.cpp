@@ -0,0 +1,100 @@
+/**
+ * @file cross_fm_kernel.cpp
+ * @brief Cross FM Noise Synthesizer - 相互位相変調デュアルオシレーター実装
+ */
+
+#include "../include/cross_fm_kernel.h"
+#include <cmath>
+
+namespace
+{
+constexpr int      kTableBits    = 10;
+constexpr int      kTableSize    = 1 << kTableBits;
+constexpr int      kFracBits     = 32 - kTableBits;
+constexpr uint32_t kFracMask     = (1u << kFracBits) - 1;
+constexpr float    kFracScale    = 1.0f / (float)(1u << kFracBits);
+constexpr float    kIdxScalar    = 0.2f;  // DaisySP Fm2と同じインデックスの係数
+constexpr float    kMaxIncrement = 0.49f; // 位相増分の上限（周期/サンプル、ナイキスト手前）
+
+float g_sine_table[kTableSize + 1]; // 補間用に1点多く持つ
+
+inline float Sine(uint32_t phase)
+{
+    const uint32_t index = phase >> kFracBits;
+    const float    frac  = (float)(phase & kFracMask) * kFracScale;
+    const float    a     = g_sine_table[index];
+    return a + (g_sine_table[index + 1] - a) * frac;
+}
+
+// 周期単位の値を32bit位相へ（整数周期分は捨てる、負の値はそのまま逆回転）
+inline uint32_t CyclesToPhase(float cycles)
+{
+    cycles -= (float)(int32_t)cycles; // (-1, 1)
+    return (uint32_t)(int32_t)(cycles * 2147483648.0f) << 1;
+}
+
+inline float Clamp(float x, float limit)
+{
+    return x > limit ? limit : (x < -limit ? -limit : x);
+}
+} // namespace
+
+void CrossFmKernel::Init(float sample_rate)
+{
+    for (int i = 0; i <= kTableSize; i++) {
+        g_sine_table[i] = sinf(6.28318530717958647692f * (float)i / (float)kTableSize);
+    }
+    phase_per_hz_     = 1.0f / sample_rate;
+    max_phase_offset_ = 20.0f * kIdxScalar;
+    for (Voice &voice : voice_) {
+        voice.params    = VoiceParams{0.0f, 0.0f, 0.0f, true};
+        voice.car_phase = 0;
+        voice.mod_phase = 0;
+        voice.freq      = 0.0f;
+        voice.index     = 0.0f;
+        voice.ratio     = 0.0f;
+    }
+}
+
+void CrossFmKernel::Reseed(int voice, float freq, float index, float ratio)
+{
+    voice_[voice].freq  = freq;
+    voice_[voice].index = index * kIdxScalar;
+    voice_[voice].ratio = ratio;
+}
+
+// Fm2::Process() と同じ順序: モジュレーター → キャリアへ位相加算 → キャリア
+inline float CrossFmKernel::Render(Voice &voice) const
+{
+    if (!voice.params.enabled) return 0.0f;
+    const float mod = Sine(voice.mod_phase);
+    voice.mod_phase += CyclesToPhase(Clamp(voice.freq * voice.ratio * phase_per_hz_, kMaxIncrement));
+    voice.car_phase += CyclesToPhase(Clamp(mod * voice.index, max_phase_offset_));
+    const float out = Sine(voice.car_phase);
+    voice.car_phase += CyclesToPhase(Clamp(voice.freq * phase_per_hz_, kMaxIncrement));
+    return out;
+}
+
+// 相手の出力で周波数・インデックス・レシオをまとめて変調（負の値もそのまま使う）
+inline void CrossFmKernel::Update(Voice &voice, float mod) const
+{
+    voice.freq  = voice.params.freq_scale * mod;
+    voice.index = voice.params.index_scale * kIdxScalar * mod;
+    voice.ratio = voice.params.ratio_scale * mod;
+}
+
+void CrossFmKernel::Process(float *out0, float *out1, uint32_t size, uint32_t update_mask)
+{
+    Voice &voice0 = voice_[0];
+    Voice &voice1 = voice_[1];
+    for (uint32_t i = 0; i < size; i++) {
+        const float o0 = Render(voice0);
+        const float o1 = Render(voice1);
+        out0[i] = o0;
+        out1[i] = o1;
+        if ((i & update_mask) == 0) {
+            Update(voice0, o1);
+            Update(voice1, o0);
+        }
+    }
+}
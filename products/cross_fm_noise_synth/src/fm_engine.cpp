@@ -5,6 +5,7 @@
 
 #include "fm_engine.h"
 #include <daisysp.h>
+#include "pico/audio.h"
 #include <cmath>
 
 using namespace daisysp;
@@ -58,6 +59,6 @@ int32_t fm_engine_process(FMEngine *engine) {
     // ミックス
     float mixed_output = (out1 + out2) * 0.5f * 0.3f;  // 音量調整
     
-    // 32bit PCMに変換
-    return (int32_t)(mixed_output * 2147483647.0f);
+    // 32bit PCMに変換（飽和付き）
+    return audio_f32_to_s32(mixed_output);
 }
\ No newline at end of file
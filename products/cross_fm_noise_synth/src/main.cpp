@@ -3,7 +3,7 @@
  * @brief Cross FM Noise Synthesizer - 参照版（pico2_i2s_pio）の完全再現
  * 
  * 2つのFMシンセが相互に変調し合う実験的なシンセサイザー
- * - DaisySP Fm2クラスを使用
+ * - Fm2構成（キャリア + モジュレーター）の相互位相変調カーネル（スルーゼロFM）
  * - アナログマルチプレクサーによる8ノブ制御
  * - オーバードライブ + アンチエイリアスフィルター + DCブロック
  * - リアルタイムクロスモジュレーション
@@ -13,7 +13,11 @@
 #include <cmath>
 #include "pico/stdlib.h"
 #include "pico/audio_i2s.h"
+#include "pico/audio_i2s_pipeline.h"
 #include "pico/audio.h"
+#include "pico/audio_trace.h"
+#include "pico/audio_latency.h"
+#include "pico/audio_tap.h"
 #include "pico/multicore.h"
 #include "hardware/adc.h"
 #include "hardware/clocks.h"
@@ -25,21 +29,33 @@
 
 #include "../include/analog_mux.h"
 #include "../include/biquad_rbj.h"
+#include "../include/block_analysis.h"
+#include "../include/cross_fm_kernel.h"
+#include "../include/quality_scheduler.h"
+#include "../include/waveshaper.h"
+#include "../include/param_store.h"
+#include "../include/synth_config.h"
 
 using namespace daisysp;
 
-// グローバル状態
-static audio_buffer_pool_t *g_audio_pool;
-
-// DaisySP オーディオ処理オブジェクト
-static Fm2 fm1, fm2;            // 2つのFMシンセ
-static Overdrive overdrive;     // オーバードライブエフェクト
+// オーディオ処理オブジェクト
+static CrossFmKernel g_cross_fm; // 相互変調し合う2つのFMシンセ
+static Waveshaper<float> overdrive; // オーバードライブ（Overdrive相当のカーブをテーブル参照）
 static DcBlock dcBlock;         // 直流オフセット除去フィルタ
 static BiquadRBJ antiAliasFilter1, antiAliasFilter2; // アンチエイリアスフィルター
+static QualityScheduler g_quality; // 過負荷時の品質スケジューラ（Core1）
+static EnvelopeFollower g_envelope;  // 出力レベル（Core1、音量適用前）
+static SilenceDetector g_silence;    // ランダム復帰の判定（Core1）
+static ZeroCrossingPitch g_pitch;    // 出力の周波数推定（Core1）
+static uint32_t g_reseed_count;      // ランダム復帰した回数
 
-// アナログマルチプレクサー
+// アナログマルチプレクサー（Core0専用）
 static AnalogMux g_analog_mux;
 
+// コア間パラメーター受け渡し（Core0が公開、Core1がブロック先頭で取得）
+static ParamStore<SynthParams> g_param_store;
+static SynthParams g_control_params;  // Core0側の作業コピー
+
 // 参照版と同じピン設定
 enum {
     kPinNEnable = 0,  // Enable pin (active low)
@@ -57,10 +73,71 @@ enum {
 // #define SAMPLES_PER_BUFFER 1156 // 大きなバッファ（元の値）
 #endif
 
+// オーディオパイプライン（フォーマット・バッファ数・DMAチャンネルをコンパイル時に確定）
+// Core1はfloatで書き込み、I2S出力は32bit（変換はI2S接続側で飽和付きで行う）
+struct SynthPipelineConfig {
+    using input_fmt  = Stereo<FmtF32>;
+    using output_fmt = Stereo<FmtS32>;
+    static constexpr uint32_t sample_freq = 48000;
+    static constexpr uint buffer_count = 3;
+    static constexpr uint buffer_frames = SAMPLES_PER_BUFFER;
+    static constexpr uint consumer_buffer_count = 2;
+    static constexpr uint consumer_buffer_frames = 256;
+    static constexpr bool buffer_on_give = false;
+    static constexpr audio_i2s_config_t i2s = {
+        .data_pin = PICO_AUDIO_I2S_DATA_PIN,
+        .clock_pin_base = PICO_AUDIO_I2S_CLOCK_PIN_BASE,
+        .dma_channel0 = 0,
+        .dma_channel1 = 1,
+        .pio_sm = 0
+    };
+};
+using SynthPipeline = audio_i2s_pipeline<SynthPipelineConfig>;
+
+// オーディオタップ（PICO_AUDIO_TAP=1 のとき tools/tap_to_wav.py で録音できる内部信号）
+enum {
+    SYNTH_TAP_MIX = AUDIO_TAP_USER, // ミックス + オーバードライブ後、音量適用前（モノラル）
+    SYNTH_TAP_FM1,                  // FM1の出力（モノラル）
+    SYNTH_TAP_FM2,                  // FM2の出力（モノラル）
+};
+static constexpr audio_format_t kTapFormat = {
+    .sample_freq = SynthPipelineConfig::sample_freq,
+    .pcm_format = AUDIO_PCM_FORMAT_F32,
+    .channel_count = AUDIO_CHANNEL_MONO,
+};
+
+// グローバル状態
+static AudioPool<SynthPipelineConfig::input_fmt> g_audio_pool; // フレーム単位の型付きアクセス
+
+// 高速起動: 電源投入直後からI2Sを動かし、USB CDCの列挙は後から非同期に進める
+// （起動待ちと起動ログを省き、オーディオ → USB → ノブの順に初期化する）
+#ifndef SYNTH_FAST_BOOT
+#define SYNTH_FAST_BOOT 0
+#endif
+
+#if SYNTH_FAST_BOOT
+#define BOOT_LOG(...) ((void)0)
+#else
+#define BOOT_LOG(...) printf(__VA_ARGS__)
+#endif
+
+#if PICO_AUDIO_LATENCY
+static constexpr int LATENCY_PROBE_COUNT = 100;  // 'l' 1回あたりのプローブ数
+#endif
+
+
+// 品質段階（過負荷時に上から順に間引く）
+enum QualityLevel {
+    QUALITY_FULL = 0,        // 参照版どおり: クロスモジュレーション更新 2サンプルごと
+    QUALITY_CROSSMOD_4,      // クロスモジュレーション更新 4サンプルごと
+    QUALITY_CROSSMOD_8,      // クロスモジュレーション更新 8サンプルごと
+    QUALITY_NO_OVERDRIVE,    // さらにオーバードライブをバイパス（クリップのみ）
+    QUALITY_LEVEL_COUNT
+};
 
 // グローバル変数
-static bool audio_enabled = false;
-static constexpr int32_t DAC_ZERO = 1;  // DACのゼロレベル
+// DACのゼロレベル（S32変換後に1 LSBとなる値 = 2^-31）
+static constexpr float DAC_ZERO = 1.0f / 2147483648.0f;
 
 // 参照版のscaleValue関数
 float scaleValue(int input, int input_min, int input_max, float output_min, float output_max, float curve = 1.0f)
@@ -90,176 +167,181 @@ inline float dbtoa(float dB)
  * @brief Core1で実行されるオーディオ処理ループ（参照版の完全再現）
  */
 void core1_audio_loop() {
-    printf("Core1 FM Cross-Modulation processing started\n");
+    // I2SのDMA割り込みをこのコアに登録して再生を開始
+    audio_i2s_attach_irq();
+    BOOT_LOG("Core1 FM Cross-Modulation processing started\n");
     uint32_t buffer_count = 0;
     
     
     // **参照版の2つのFMシンセ初期化**
     const float sample_rate = 48000.0f;
     
-    printf("Initializing DaisySP Cross FM synth at %.0fHz...\n", sample_rate);
-    
-    // FM1初期化（参照版と同じ設定）
-    fm1.Init(sample_rate);
-    fm1.SetFrequency(440.0f);
-    fm1.SetRatio(0.5f);
-    fm1.SetIndex(100.0f);
-    printf("FM1 initialized: 440Hz, ratio=0.5, index=100\n");
+    BOOT_LOG("Initializing DaisySP Cross FM synth at %.0fHz...\n", sample_rate);
     
-    // FM2初期化（参照版と同じ設定）
-    fm2.Init(sample_rate);
-    fm2.SetFrequency(330.0f);
-    fm2.SetRatio(0.33f);
-    fm2.SetIndex(50.0f);
-    printf("FM2 initialized: 330Hz, ratio=0.33, index=50\n");
+    // FM1/FM2初期化（参照版と同じ設定）
+    g_cross_fm.Init(sample_rate);
+    g_cross_fm.Reseed(0, 440.0f, 100.0f, 0.5f);
+    BOOT_LOG("FM1 initialized: 440Hz, ratio=0.5, index=100\n");
+    g_cross_fm.Reseed(1, 330.0f, 50.0f, 0.33f);
+    BOOT_LOG("FM2 initialized: 330Hz, ratio=0.33, index=50\n");
     
     // オーバードライブ初期化（参照版と同じ）
     overdrive.Init();
-    overdrive.SetDrive(0.5f);
-    printf("Overdrive initialized with drive=0.5\n");
+    BOOT_LOG("Overdrive initialized with drive=0.5\n");
     
-    printf("Cross FM synthesizer with overdrive initialized successfully\n");
+    BOOT_LOG("Cross FM synthesizer with overdrive initialized successfully\n");
+
+    // 品質スケジューラ初期化（デッドライン = 1ブロックの再生時間）
+    QualityScheduler::Config quality_config;
+    quality_config.deadline_us = (uint32_t)(SAMPLES_PER_BUFFER * 1000000.0f / sample_rate);
+    quality_config.max_level = QUALITY_LEVEL_COUNT - 1;
+    g_quality.Init(quality_config);
+    int quality_level = QUALITY_FULL;
+
+    // ブロック解析の初期化
+    g_envelope.Init(sample_rate, 1.0f, 100.0f);
+    g_silence.Init(SilenceDetector::Config());
+    g_pitch.Init(sample_rate);
+
+    // Core1側のパラメータースナップショット
+    SynthParams params = {};
+    uint32_t params_sequence = 0;
     
-    // 参照版と完全同じ変数
-    static float out1, out2, mixed_out;
-    static int32_t sample;
-    static float volume = 0.8f; // 参照版と同じデフォルトボリューム
+    // FM1/FM2のブロック出力
+    static float out1[SynthPipelineConfig::buffer_frames], out2[SynthPipelineConfig::buffer_frames];
     
     while (true) {
-        audio_buffer_t *buffer = take_audio_buffer(g_audio_pool, true);
+        AudioBuffer<SynthPipelineConfig::input_fmt> buffer = g_audio_pool.take();
         if (!buffer) {
             printf("Failed to get audio buffer!\n");
             continue;
         }
 
-        int32_t *samples = (int32_t *)buffer->buffer->bytes;
-        const uint32_t sample_count = buffer->max_sample_count;
+        audio_trace(AUDIO_TRACE_RENDER_START, buffer_count);
 
-        if (audio_enabled) {
-            
-            // アナログマルチプレクサーの値を取得（参照版と完全同じ）
-            g_analog_mux.Update();
-            const int val0 = (int)(g_analog_mux.GetNormalizedValue(0) * 1023);
-            const int val1 = (int)(g_analog_mux.GetNormalizedValue(1) * 1023);
-            const int val2 = (int)(g_analog_mux.GetNormalizedValue(2) * 1023);
-            const int val3 = (int)(g_analog_mux.GetNormalizedValue(3) * 1023);
-            const int val4 = (int)(g_analog_mux.GetNormalizedValue(4) * 1023);
-            const int val5 = (int)(g_analog_mux.GetNormalizedValue(5) * 1023);
-            const int val6 = (int)(g_analog_mux.GetNormalizedValue(6) * 1023);
-            const int val7 = (int)(g_analog_mux.GetNormalizedValue(7) * 1023);
-            
-            // FM Cross-Modulation処理
+        // float のまま書き込む（S32への飽和変換はI2S接続側でまとめて行う）
+        const auto frames = buffer.frames();
+        const uint32_t sample_count = frames.size();
+
+        // ブロック先頭で最新のパラメーターを取得（更新がなければ前回の値を使う）
+        g_param_store.ReadIfChanged(params, params_sequence);
+
+        if (params.audio_enabled) {
+            g_quality.BeginBlock();
+
+            // ノブ値（Core0がアナログマルチプレクサーから読み取って公開したもの）
+            const int val0 = params.knobs[0];
+            const int val1 = params.knobs[1];
+            const int val2 = params.knobs[2];
+            const int val3 = params.knobs[3];
+            const int val4 = params.knobs[4];
+            const int val5 = params.knobs[5];
+            const int val6 = params.knobs[6];
+            const int val7 = params.knobs[7];
+
+            // 品質段階に応じた処理の間引き
+            const uint32_t crossmod_mask = quality_level >= QUALITY_CROSSMOD_8 ? 7
+                                         : quality_level >= QUALITY_CROSSMOD_4 ? 3 : 1;
+            const bool use_overdrive = quality_level < QUALITY_NO_OVERDRIVE;
+
+            // ノブ値はブロック内で一定なので、ドライブと音量はブロック単位で設定（ドライブはブロック内で補間）
+            overdrive.SetDrive(scaleValue(val6, 0, 1023, 0.0f, 1.0f));
+            const float volume = dbtoa(scaleValue(val7, 0, 1023, -70.0f, 6.0f)); // 参照版と同じdBスケーリング
+
+            // **参照版の意図的破綻設計（相手の出力で周波数・インデックス・レシオを直接変調）**
+            // val0/val3=0 でそのFMシンセは停止（ここは0が一番音が良い気がする）
+            g_cross_fm.SetVoice(0, {scaleValue(val0, 0, 1023, 0.0f, 1000.0f),
+                                    scaleValue(val1, 0, 1023, 0.0f, 20.0f),
+                                    scaleValue(val2, 0, 1023, 0.0f, 20.0f), val0 > 0});
+            g_cross_fm.SetVoice(1, {scaleValue(val3, 0, 1023, 0.0f, 1000.0f),
+                                    scaleValue(val4, 0, 1023, 0.0f, 20.0f),
+                                    scaleValue(val5, 0, 1023, 0.0f, 20.0f), val3 > 0});
+            g_cross_fm.Process(out1, out2, sample_count, crossmod_mask);
+            audio_tap_write(SYNTH_TAP_FM1, &kTapFormat, out1, sample_count);
+            audio_tap_write(SYNTH_TAP_FM2, &kTapFormat, out2, sample_count);
+
+            // ミキシング（平均化）
             for (uint32_t i = 0; i < sample_count; i++) {
-                // **参照版の意図的破綻設計：val0=0で最高音質**
-                if (val0 > 0) { // ここは0が一番音が良い気がする
-                    out1 = fm1.Process();
-                } else {
-                    out1 = 0.0f;
-                }
-                
-                if (val3 > 0) {
-                    out2 = fm2.Process();
-                } else {
-                    out2 = 0.0f;
-                }
+                out1[i] = (out1[i] + out2[i]) * 0.5f;
+            }
 
-                // ミキシング（平均化）
-                mixed_out = (out1 + out2) * 0.5f;
+            // **オーバードライブエフェクト（参照版と同じ順序）**
+            if (use_overdrive) {
+                overdrive.ProcessBlock(out1, sample_count);
+            }
+            audio_tap_write(SYNTH_TAP_MIX, &kTapFormat, out1, sample_count);
 
-                // **オーバードライブエフェクト（参照版と同じ順序）**
-                mixed_out = overdrive.Process(mixed_out);
-                
-                // ボリューム適用（参照版と完全同じdBスケーリング）
-                mixed_out *= dbtoa(scaleValue(val7, 0, 1023, -70.0f, 6.0f));
+            for (uint32_t i = 0; i < sample_count; i++) {
+                const float mixed_out = out1[i] * volume;
                 
-                // クリッピング防止
-                if (mixed_out > 1.0f) mixed_out = 1.0f;
-                if (mixed_out < -1.0f) mixed_out = -1.0f;
-
-                // 32bit signed integerに変換
-                sample = (int32_t)(mixed_out * 2147483647.0f);
-                samples[i * 2 + 0] = sample;  // Left
-                samples[i * 2 + 1] = sample;  // Right
-
-                // 出力音のレベルを監視して、一定より小さかったらFMシンセのパラメータをランダムに動かす（参照版完全再現）
-                if (fabsf(mixed_out) < 0.01f) {
-                    // ランダムな値を生成してFMシンセのパラメータを更新
-                    fm1.SetFrequency(100 + (rand() % 900)); // 周波数をランダムに設定
-                    fm1.SetIndex(rand() % 20); // インデックスをランダムに設定
-                    fm1.SetRatio(1 + (rand() % 19)); // レシオをランダムに設定
-                    fm2.SetFrequency(100 + (rand() % 900)); // 周波数をランダムに設定
-                    fm2.SetIndex(rand() % 20); // インデックスをランダムに設定
-                    fm2.SetRatio(1 + (rand() % 19)); // レシオをランダムに設定
-                }
-
-                // **参照版の意図的破綻設計（直接乗算によるクロスモジュレーション）**
-                if (i % 2 == 0) {
-                    // 1つ目のFMシンセのインデックスとレシオを動的に設定
-                    fm1.SetFrequency(scaleValue(val0, 0, 1023, 0.0f, 1000.0f) * out2); // 出力値を基に周波数を設定
-                    fm1.SetIndex(scaleValue(val1, 0, 1023, 0.0f, 20.0f) * out2); // 出力値を基にインデックスを設定
-                    fm1.SetRatio(scaleValue(val2, 0, 1023, 0.0f, 20.0f) * out2); // 出力値を基にレシオを設定
-                    // 2つ目のFMシンセのインデックスとレシオを動的に設定
-                    fm2.SetFrequency(scaleValue(val3, 0, 1023, 0.0f, 1000.0f) * out1); // 出力値を基に周波数を設定
-                    fm2.SetIndex(scaleValue(val4, 0, 1023, 0.0f, 20.0f) * out1); // 出力値を基にインデックスを設定
-                    fm2.SetRatio(scaleValue(val5, 0, 1023, 0.0f, 20.0f) * out1); // 出力値を基にレシオを設定
-                    // **オーバードライブのドライブを動的に設定（val6で制御）**
-                    overdrive.SetDrive(scaleValue(val6, 0, 1023, 0.0f, 1.0f)); // 出力値を基にドライブを設定
-                }
+                frames[i][0] = mixed_out;  // Left
+                frames[i][1] = mixed_out;  // Right
+            }
+
+            // 出力音のレベルと周波数をブロック単位で監視（音量ノブの影響を受けないよう音量適用前）
+            g_envelope.Process(out1, sample_count);
+            g_pitch.Process(out1, sample_count);
+
+            // 無音が続いたらFMシンセのパラメータをランダムに動かす（次のブロックの先頭に反映）
+            // 判定をやり直すので、動かしても無音のままなら hold_blocks ごとに再試行する
+            if (g_silence.Update(g_envelope.GetBlockRms())) {
+                g_cross_fm.Reseed(0, 100 + (rand() % 900), rand() % 20, 1 + (rand() % 19));
+                g_cross_fm.Reseed(1, 100 + (rand() % 900), rand() % 20, 1 + (rand() % 19));
+                g_silence.Reset();
+                g_reseed_count++;
             }
             
             buffer_count++;
+            quality_level = g_quality.EndBlock();
         } else {
             // 無音
             for (uint32_t i = 0; i < sample_count; i++) {
-                samples[i * 2 + 0] = DAC_ZERO;  // Left
-                samples[i * 2 + 1] = DAC_ZERO;  // Right
+                frames[i][0] = DAC_ZERO;  // Left
+                frames[i][1] = DAC_ZERO;  // Right
             }
         }
 
-        buffer->sample_count = sample_count;
-        give_audio_buffer(g_audio_pool, buffer);
+        audio_trace(AUDIO_TRACE_RENDER_STOP, buffer_count);
+        buffer.give(sample_count);
     }
 }
 
 /**
- * @brief システム初期化
+ * @brief ノブを読み取り、変化があればCore1へ公開する（Core0から呼ぶ）
+ * @param force 変化がなくても公開する
  */
-bool init_synth() {
-    stdio_init_all();
-    
-    // Pico 2 内蔵LED初期化
-    const uint LED_PIN = 25;
-    gpio_init(LED_PIN);
-    gpio_set_dir(LED_PIN, GPIO_OUT);
-    gpio_put(LED_PIN, 1);  // 起動完了表示
-    
-    // USBシリアル接続の確実な確立
-    sleep_ms(3000);  // 3秒待機に延長
-    
-    printf("=== Cross FM Synthesizer v3.0 ===\n");
-    printf("Build time: " __DATE__ " " __TIME__ "\n");
-    printf("System starting...\n");
-    
-    // 初期化の各ステップでデバッグ出力
-    printf("Step 1: USB Serial established\n");
-    
-    // LED点灯でStep 1完了を表示
-    gpio_put(LED_PIN, 1);
-    
-    printf("Step 2: Using default system clock configuration\n");
-    printf("  clk_sys: %u Hz (%.1f MHz)\n", clock_get_hz(clk_sys), clock_get_hz(clk_sys) / 1000000.0f);
-    printf("  clk_peri: %u Hz (%.1f MHz)\n", clock_get_hz(clk_peri), clock_get_hz(clk_peri) / 1000000.0f);
-    
-    // DCDC電源制御
-    printf("Step 4: Configuring DCDC for low-noise audio...\n");
+static void update_controls(bool force) {
+    g_analog_mux.Update();
+    bool changed = force;
+    for (int i = 0; i < SYNTH_KNOB_COUNT; i++) {
+        const uint16_t value = (uint16_t)(g_analog_mux.GetNormalizedValue(i) * 1023);
+        if (value != g_control_params.knobs[i]) {
+            g_control_params.knobs[i] = value;
+            changed = true;
+        }
+    }
+    if (changed) {
+        g_param_store.Publish(g_control_params);
+    }
+}
+
+/**
+ * @brief DCDCをPWMモードにする（オーディオノイズ低減）
+ */
+static void init_power() {
+    BOOT_LOG("Step 4: Configuring DCDC for low-noise audio...\n");
     const uint32_t PIN_DCDC_PSM_CTRL = 23;
     gpio_init(PIN_DCDC_PSM_CTRL);
     gpio_set_dir(PIN_DCDC_PSM_CTRL, GPIO_OUT);
     gpio_put(PIN_DCDC_PSM_CTRL, 1);
-    printf("Step 5: DCDC configured\n");
-    
-    // アナログマルチプレクサー初期化
-    printf("Step 6: Initializing analog multiplexer...\n");
+    BOOT_LOG("Step 5: DCDC configured\n");
+}
+
+/**
+ * @brief アナログマルチプレクサー初期化
+ */
+static void init_controls() {
+    BOOT_LOG("Step 6: Initializing analog multiplexer...\n");
     AnalogMux::Config mux_config = {
         .pin_enable = kPinNEnable,
         .pin_s0 = kPinS0,
@@ -271,79 +353,126 @@ bool init_synth() {
         .enable_active_low = true
     };
     g_analog_mux.Init(mux_config);
-    printf("Step 7: Analog multiplexer initialized\n");
-    
-    // オーディオシステム初期化
-    static audio_format_t audio_format = {
-        .sample_freq = 48000,
-        .pcm_format = AUDIO_PCM_FORMAT_S32,
-        .channel_count = AUDIO_CHANNEL_STEREO
-    };
-    
-    static audio_buffer_format_t producer_format = {
-        .format = &audio_format,
-        .sample_stride = 8
-    };
-    
-    static audio_i2s_config_t i2s_config = {
-        .data_pin = PICO_AUDIO_I2S_DATA_PIN,
-        .clock_pin_base = PICO_AUDIO_I2S_CLOCK_PIN_BASE,
-        .dma_channel0 = 0,
-        .dma_channel1 = 1,
-        .pio_sm = 0
-    };
-    
-    printf("I2S Config: data_pin=%d, clock_pin_base=%d\n", 
-           i2s_config.data_pin, i2s_config.clock_pin_base);
-    
-    g_audio_pool = audio_new_producer_pool(&producer_format, 3, SAMPLES_PER_BUFFER);
-    if (!g_audio_pool) {
-        printf("Failed to create audio buffer pool\n");
-        return false;
-    }
-    printf("Audio buffer pool created successfully\n");
+    BOOT_LOG("Step 7: Analog multiplexer initialized\n");
+}
+
+/**
+ * @brief オーディオ出力を初期化してCore1を起動する
+ *
+ * Core1は audio_enabled が公開されるまで無音をレンダリングする。
+ */
+static bool init_audio() {
+    BOOT_LOG("I2S Config: data_pin=%d, clock_pin_base=%d\n", 
+             SynthPipelineConfig::i2s.data_pin, SynthPipelineConfig::i2s.clock_pin_base);
+    BOOT_LOG("Audio pipeline: %u bytes of static buffers\n", (unsigned)SynthPipeline::storage_bytes);
     
-    const audio_format_t *output_format = audio_i2s_setup(&audio_format, &audio_format, &i2s_config);
+    const audio_format_t *output_format = SynthPipeline::setup();
     if (!output_format) {
         printf("PicoAudio: Unable to open audio device.\n");
         return false;
     }
     
-    printf("I2S setup successful, output format: freq=%d\n", output_format->sample_freq);
+    BOOT_LOG("I2S setup successful, output format: freq=%d\n", output_format->sample_freq);
     
-    printf("Connecting audio pool to I2S...\n");
-    bool connect_result = audio_i2s_connect(g_audio_pool);
+    BOOT_LOG("Connecting audio pool to I2S...\n");
+    bool connect_result = SynthPipeline::connect();
     if (!connect_result) {
         printf("Failed to connect audio pool to I2S!\n");
         return false;
     }
-    printf("Audio pool connected successfully\n");
+    g_audio_pool = SynthPipeline::typed_producer();
+    BOOT_LOG("Audio pool connected successfully\n");
     
     // 初期バッファデータ設定
     {
-        audio_buffer_t *ab = take_audio_buffer(g_audio_pool, true);
-        int32_t *samples = (int32_t *) ab->buffer->bytes;
-        for (uint i = 0; i < ab->max_sample_count; i++) {
-            samples[i*2+0] = DAC_ZERO;
-            samples[i*2+1] = DAC_ZERO;
+        auto ab = g_audio_pool.take();
+        for (auto &frame : ab.frames()) {
+            frame[0] = DAC_ZERO;
+            frame[1] = DAC_ZERO;
         }
-        ab->sample_count = ab->max_sample_count;
-        give_audio_buffer(g_audio_pool, ab);
+        ab.give();
     }
     
-    printf("Enabling I2S output...\n");
+    BOOT_LOG("Enabling I2S output...\n");
+    // DMA割り込みはCore1（レンダリング側）で受ける。Core0はUSB/UI処理に専念させる
+    // （DMAの開始はCore1のaudio_i2s_attach_irq()で行われる）
+    audio_i2s_set_irq_core(1);
     audio_i2s_set_enabled(true);
-    printf("I2S output enabled\n");
+    BOOT_LOG("I2S output enabled\n");
     
-    printf("Launching Core1 audio processing...\n");
+    BOOT_LOG("Launching Core1 audio processing...\n");
     multicore_launch_core1(core1_audio_loop);
+    return true;
+}
+
+/**
+ * @brief システム初期化
+ */
+bool init_synth() {
+#if SYNTH_FAST_BOOT
+    // オーディオを最優先で立ち上げる（Core1はノブが揃うまで無音を出す）
+    init_power();
+    if (!init_audio()) {
+        return false;
+    }
+
+    // USB CDCの列挙はUSB割り込みで非同期に進むので待たない
+    stdio_init_all();
+
+    const uint LED_PIN = 25;
+    gpio_init(LED_PIN);
+    gpio_set_dir(LED_PIN, GPIO_OUT);
+    gpio_put(LED_PIN, 1);  // 起動完了表示
+
+    init_controls();
+    g_control_params.audio_enabled = true;
+    update_controls(true);
+    return true;
+#else
+    stdio_init_all();
+    
+    // Pico 2 内蔵LED初期化
+    const uint LED_PIN = 25;
+    gpio_init(LED_PIN);
+    gpio_set_dir(LED_PIN, GPIO_OUT);
+    gpio_put(LED_PIN, 1);  // 起動完了表示
+    
+    // USBシリアル接続の確実な確立
+    sleep_ms(3000);  // 3秒待機に延長
+    
+    printf("=== Cross FM Synthesizer v3.0 ===\n");
+    printf("Build time: " __DATE__ " " __TIME__ "\n");
+    printf("System starting...\n");
+    
+    // 初期化の各ステップでデバッグ出力
+    printf("Step 1: USB Serial established\n");
+    
+    // LED点灯でStep 1完了を表示
+    gpio_put(LED_PIN, 1);
+    
+    printf("Step 2: Using default system clock configuration\n");
+    printf("  clk_sys: %u Hz (%.1f MHz)\n", clock_get_hz(clk_sys), clock_get_hz(clk_sys) / 1000000.0f);
+    printf("  clk_peri: %u Hz (%.1f MHz)\n", clock_get_hz(clk_peri), clock_get_hz(clk_peri) / 1000000.0f);
+    
+    // DCDC電源制御
+    init_power();
+    
+    // アナログマルチプレクサー初期化
+    init_controls();
+    update_controls(true);
+
+    if (!init_audio()) {
+        return false;
+    }
     
     sleep_ms(500);
     printf("Enabling audio generation...\n");
-    audio_enabled = true;
+    g_control_params.audio_enabled = true;
+    update_controls(true);
     
     printf("Cross FM Synthesizer initialized\n");
     return true;
+#endif
 }
 
 /**
@@ -365,29 +494,73 @@ int main() {
     printf("  val5: FM2 Ratio Base (0-20)\n");
     printf("  val6: Overdrive Drive (0.0-1.0)\n");
     printf("  val7: Master Volume (-70dB to +6dB)\n");
-    printf("Cross-modulation: FM1 <-> FM2 mutual modulation (intentional chaos!)\n\n");
+    printf("Cross-modulation: FM1 <-> FM2 mutual modulation (intentional chaos!)\n");
+#if PICO_AUDIO_TRACE
+    printf("Trace: 't' = dump audio trace, 'r' = reset trace\n");
+#endif
+#if PICO_AUDIO_LATENCY
+    printf("Latency: 'l' = run %d probes, 'p' = print latency report\n", LATENCY_PROBE_COUNT);
+#endif
+#if PICO_AUDIO_TAP
+    // USBはタップ用のベンダーデバイスになる（stdioはUART）
+    audio_tap_usb_init();
+    printf("Tap: %d = I2S output, %d = mix, %d = FM1, %d = FM2 (tools/tap_to_wav.py --tap N)\n",
+           AUDIO_TAP_I2S_OUTPUT, SYNTH_TAP_MIX, SYNTH_TAP_FM1, SYNTH_TAP_FM2);
+#endif
+    printf("\n");
     
     // メインループ（参照版はArduinoのloop()なので、ここは最小限）
+    // ノブの読み取りと公開はここ（Core0）だけで行う
     while (true) {
+        update_controls(false);
+
         // デバッグ情報を定期的に出力
         static uint32_t last_debug_time = 0;
         uint32_t current_time = to_ms_since_boot(get_absolute_time());
         
         if (current_time - last_debug_time > 10000) {  // 10秒ごと
-            g_analog_mux.Update();
+            const uint16_t *knobs = g_control_params.knobs;
             printf("Knobs: %d %d %d %d %d %d %d %d\n",
-                   (int)(g_analog_mux.GetNormalizedValue(0) * 1023),
-                   (int)(g_analog_mux.GetNormalizedValue(1) * 1023),
-                   (int)(g_analog_mux.GetNormalizedValue(2) * 1023),
-                   (int)(g_analog_mux.GetNormalizedValue(3) * 1023),
-                   (int)(g_analog_mux.GetNormalizedValue(4) * 1023),
-                   (int)(g_analog_mux.GetNormalizedValue(5) * 1023),
-                   (int)(g_analog_mux.GetNormalizedValue(6) * 1023),
-                   (int)(g_analog_mux.GetNormalizedValue(7) * 1023));
+                   knobs[0], knobs[1], knobs[2], knobs[3],
+                   knobs[4], knobs[5], knobs[6], knobs[7]);
+            printf("Quality: level %d, load %d%%, peak %uus, degrades %u, misses %u\n",
+                   g_quality.GetLevel(), (int)(g_quality.GetLoad() * 100),
+                   (unsigned)g_quality.GetPeakUs(), (unsigned)g_quality.GetDegradeCount(),
+                   (unsigned)g_quality.GetMissCount());
+            printf("Signal: rms %.3f, peak %.3f, pitch %.0fHz, reseeds %u\n",
+                   g_envelope.GetRms(), g_envelope.GetPeak(), g_pitch.GetFrequency(),
+                   (unsigned)g_reseed_count);
             last_debug_time = current_time;
         }
+
+#if PICO_AUDIO_TRACE || PICO_AUDIO_LATENCY
+        int c = getchar_timeout_us(0);
+#endif
+#if PICO_AUDIO_TRACE
+        // USB経由のトレースダンプコマンド（tools/trace_to_chrome.py で変換）
+        if (c == 't') {
+            audio_trace_dump();
+        } else if (c == 'r') {
+            audio_trace_reset();
+        }
+#endif
+#if PICO_AUDIO_LATENCY
+        // レイテンシ計測（プローブごとにクリック音が出るので出力はミュートしておく）
+        if (c == 'l') {
+            audio_latency_reset();
+            audio_latency_probe_start(LATENCY_PROBE_COUNT);
+            printf("Latency probe started\n");
+        } else if (c == 'p') {
+            audio_latency_print_report();
+        }
+#endif
+        
+#if PICO_AUDIO_TAP
+        // リングが空で止まっていたUSB転送を再開
+        audio_tap_usb_poll();
+#endif
         
-        sleep_ms(100);
+        sleep_ms(1);  // マルチプレクサーのスキャン周期（1ms）に合わせる
     }
     
     return 0;
@@ -5,6 +5,7 @@
 
 #include "noise_generator.h"
 #include <daisysp.h>
+#include "pico/audio.h"
 
 using namespace daisysp;
 
@@ -107,6 +108,6 @@ int32_t noise_generator_process(NoiseGenerator *generator) {
     // レベル調整
     output *= generator->level;
     
-    // 32bit PCMに変換
-    return (int32_t)(output * 2147483647.0f);
+    // 32bit PCMに変換（飽和付き）
+    return audio_f32_to_s32(output);
 }
\ No newline at end of file
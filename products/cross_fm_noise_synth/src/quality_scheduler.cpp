@@ -0,0 +1,58 @@
+/**
+ * @file quality_scheduler.cpp
+ * @brief Cross FM Noise Synthesizer - 負荷適応型の品質スケジューラ実装
+ */
+
+#include "../include/quality_scheduler.h"
+#include "hardware/timer.h"
+
+void QualityScheduler::Init(const Config &config)
+{
+    config_        = config;
+    level_         = 0;
+    load_          = 0.0f;
+    start_us_      = 0;
+    calm_blocks_   = 0;
+    settle_blocks_ = 0;
+    peak_us_       = 0;
+    degrade_count_ = 0;
+    miss_count_    = 0;
+}
+
+void QualityScheduler::BeginBlock()
+{
+    start_us_ = time_us_32();
+}
+
+int QualityScheduler::EndBlock()
+{
+    const uint32_t elapsed_us = time_us_32() - start_us_;
+    if (elapsed_us > peak_us_) peak_us_ = elapsed_us;
+    if (elapsed_us > config_.deadline_us) miss_count_++;
+
+    const float block_load = (float)elapsed_us / (float)config_.deadline_us;
+    load_ += (block_load - load_) * config_.smoothing;
+
+    // 段階変更直後は平滑化負荷に前の段階の負荷が残っているので、ピークでのみ判定する
+    const bool settled = settle_blocks_ == 0;
+    if (!settled) settle_blocks_--;
+
+    if ((block_load > config_.degrade_threshold || (settled && load_ > config_.degrade_threshold))
+        && level_ < config_.max_level) {
+        // ピーク1回でも即座に下げる（アンダーランを起こす前に余裕を作る）
+        level_++;
+        degrade_count_++;
+        calm_blocks_ = 0;
+        settle_blocks_ = (uint32_t)(1.0f / config_.smoothing);
+    } else if (load_ < config_.restore_threshold && level_ > 0) {
+        // 十分に長く余裕が続いた場合のみ1段戻す
+        if (++calm_blocks_ >= config_.restore_blocks) {
+            level_--;
+            calm_blocks_ = 0;
+            settle_blocks_ = (uint32_t)(1.0f / config_.smoothing);
+        }
+    } else {
+        calm_blocks_ = 0;
+    }
+    return level_;
+}
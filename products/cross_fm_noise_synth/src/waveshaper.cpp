@@ -0,0 +1,35 @@
+/**
+ * @file waveshaper.cpp
+ * @brief Cross FM Noise Synthesizer - ウェーブシェーパーの既定カーブ
+ */
+
+#include "../include/waveshaper.h"
+
+namespace
+{
+// DaisySP SoftClip と同じ有理近似（|x| > 3 で ±1）
+inline float SoftClip(float x)
+{
+    if (x < -3.0f) return -1.0f;
+    if (x > 3.0f) return 1.0f;
+    return x * (27.0f + x * x) / (27.0f + 9.0f * x * x);
+}
+} // namespace
+
+float OverdriveCurve(float drive, float x)
+{
+    // DaisySP Overdrive はドライブ 1.0 ちょうどで drive_squashed が 0 になり、ポストゲインが
+    // 1/SoftClip(0.33)（約3.1倍）に跳ねる。その直前までは 1 に張り付いているので、
+    // 最上位スライスが跳ねた値を補間で広げないよう 1 の手前で止める
+    if (drive > kOverdriveMaxDrive) drive = kOverdriveMaxDrive;
+
+    // DaisySP Overdrive::SetDrive() と同じゲイン計算
+    const float d              = 2.0f * drive;
+    const float d2             = d * d;
+    const float pre_gain_a     = d * 0.5f;
+    const float pre_gain_b     = d2 * d2 * d * 24.0f;
+    const float pre_gain       = pre_gain_a + (pre_gain_b - pre_gain_a) * d2;
+    const float drive_squashed = d * (2.0f - d);
+    const float post_gain      = 1.0f / SoftClip(0.33f + drive_squashed * (pre_gain - 0.33f));
+    return SoftClip(pre_gain * x) * post_gain;
+}
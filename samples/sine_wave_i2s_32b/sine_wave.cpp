@@ -10,6 +10,7 @@
  * - リアルタイム音量調整
  * - キーボードによるインタラクティブ制御
  * - 32bit高精度音声出力
+ * - レンダーコールバックでDMA再生バッファへ直接書き込み（プール・コピーなし）
  * 
  * 操作方法:
  * - "+"/"=": 音量アップ
@@ -17,6 +18,12 @@
  * - "["/"]": 左チャンネル周波数調整
  * - "{"/"}": 右チャンネル周波数調整
  * - "q": 終了
+ * - "v": 連続性チェック結果を表示（SINE_WAVE_VERIFY=1 のとき）
+ * 
+ * SINE_WAVE_VERIFY=1 でビルドすると、サイン波の代わりに pico/audio_verify.h の
+ * ランプ信号を出力し、I2Sドライバ側で欠落・重複・不連続・アンダーラン・
+ * タイミングジッタを検出するソークテストモードになります。
+ * （ランプはフルスケールのノコギリ波なので、スピーカーは接続しないこと）
  * 
  * Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
  * SPDX-License-Identifier: BSD-3-Clause
@@ -35,6 +42,19 @@
 #include "pico/audio_i2s.h"
 #include "analog_mux.h"
 
+#ifndef SINE_WAVE_VERIFY
+#define SINE_WAVE_VERIFY 0
+#endif
+
+#if SINE_WAVE_VERIFY
+#include "pico/audio_verify.h"
+#endif
+
+// 高速起動: USBシリアルを待たずにクロック → I2S の順で立ち上げ、起動直後から音を出す
+#ifndef SINE_WAVE_FAST_BOOT
+#define SINE_WAVE_FAST_BOOT 0
+#endif
+
 // =============================================================================
 // 定数定義
 // =============================================================================
@@ -48,12 +68,19 @@ static const uint32_t PIN_DCDC_PSM_CTRL = 23;  // DCDC PSM制御ピン（ノイ
 // グローバル変数
 // =============================================================================
 
-audio_buffer_pool_t *ap;               // オーディオバッファプール
-static bool decode_flg = false;        // 音声生成フラグ
+static volatile bool decode_flg = false; // 音声生成フラグ
 static constexpr int32_t DAC_ZERO = 1; // DAC出力のゼロレベル
 
+#if SINE_WAVE_VERIFY
+static constexpr uint32_t VERIFY_STEP = 0x00010001;        // ランプの1フレームあたりの増分
+static constexpr uint32_t VERIFY_REPORT_INTERVAL_MS = 10000; // 結果の定期表示間隔
+static uint32_t verify_phase = 0;                           // ランプの位相
+#endif
+
 #define audio_pio __CONCAT(pio, PICO_AUDIO_I2S_PIO)
 
+static void render(void *ctx, int32_t *out, uint frames, uint64_t frame_pos);
+
 // =============================================================================
 // オーディオ設定
 // =============================================================================
@@ -65,12 +92,6 @@ static audio_format_t audio_format = {
     .channel_count = AUDIO_CHANNEL_STEREO // チャンネル数: ステレオ (2ch)
 };
 
-/** バッファフォーマット設定 */
-static audio_buffer_format_t producer_format = {
-    .format = &audio_format,
-    .sample_stride = 8                   // ステレオ32bitなので8バイト/サンプル
-};
-
 /** I2S設定 */
 static audio_i2s_config_t i2s_config = {
     .data_pin = PICO_AUDIO_I2S_DATA_PIN,         // データピン (デフォルト: GP18)
@@ -135,68 +156,32 @@ static inline uint32_t _millis(void)
 /**
  * @brief I2Sオーディオシステムの終了処理
  * 
- * オーディオ出力を停止し、使用していたバッファとリソースを
- * すべて解放します。
+ * オーディオ出力を停止し、ドライバーが確保したレンダーバッファと
+ * ハードウェアリソースをすべて解放します。
  */
 void i2s_audio_deinit()
 {
     decode_flg = false;  // 音声生成を停止
 
-    // I2S出力を無効化して終了
+    // I2S出力を無効化して終了（レンダーバッファもここで解放される）
     audio_i2s_set_enabled(false);
     audio_i2s_end();
-
-    // すべてのオーディオバッファを解放
-    audio_buffer_t* ab;
-    
-    // 使用中のバッファを解放
-    ab = take_audio_buffer(ap, false);
-    while (ab != nullptr) {
-        free(ab->buffer->bytes);
-        free(ab->buffer);
-        ab = take_audio_buffer(ap, false);
-    }
-    
-    // 空きバッファを解放
-    ab = get_free_audio_buffer(ap, false);
-    while (ab != nullptr) {
-        free(ab->buffer->bytes);
-        free(ab->buffer);
-        ab = get_free_audio_buffer(ap, false);
-    }
-    
-    // フルバッファを解放
-    ab = get_full_audio_buffer(ap, false);
-    while (ab != nullptr) {
-        free(ab->buffer->bytes);
-        free(ab->buffer);
-        ab = get_full_audio_buffer(ap, false);
-    }
-    
-    // バッファプール自体を解放
-    free(ap);
-    ap = nullptr;
 }
 
 /**
  * @brief I2Sオーディオシステムの初期化
  * 
  * 指定されたサンプリング周波数でI2Sオーディオシステムを初期化し、
- * バッファプールを作成してストリーミングを開始します。
+ * レンダーコールバックを登録してストリーミングを開始します。
+ * バッファプールは使わず、DMAが再生するメモリに直接波形を書き込みます。
  * 
  * @param sample_freq サンプリング周波数 (Hz)
- * @return 初期化されたオーディオバッファプール
  */
-audio_buffer_pool_t *i2s_audio_init(uint32_t sample_freq)
+void i2s_audio_init(uint32_t sample_freq)
 {
     // サンプリング周波数を設定
     audio_format.sample_freq = sample_freq;
 
-    // オーディオバッファプールを作成
-    // 3つのバッファを使用してトリプルバッファリングを実現
-    audio_buffer_pool_t *producer_pool = audio_new_producer_pool(&producer_format, 3, SAMPLES_PER_BUFFER);
-    ap = producer_pool;
-
     bool __unused ok;
     const audio_format_t *output_format;
 
@@ -206,54 +191,49 @@ audio_buffer_pool_t *i2s_audio_init(uint32_t sample_freq)
         panic("PicoAudio: Unable to open audio device.\n");
     }
 
-    // バッファプールをI2S出力に接続
-    ok = audio_i2s_connect(producer_pool);
+    // レンダーコールバックを登録（DMAチャンネルごとに1バッファ）
+    ok = audio_i2s_set_render_callback(render, nullptr, SAMPLES_PER_BUFFER);
     assert(ok);
-    
-    // 初期バッファデータを設定（無音状態）
-    {
-        audio_buffer_t *ab = take_audio_buffer(producer_pool, true);
-        int32_t *samples = (int32_t *) ab->buffer->bytes;
-        for (uint i = 0; i < ab->max_sample_count; i++) {
-            samples[i*2+0] = DAC_ZERO;  // 左チャンネル
-            samples[i*2+1] = DAC_ZERO;  // 右チャンネル
-        }
-        ab->sample_count = ab->max_sample_count;
-        give_audio_buffer(producer_pool, ab);
-    }
-    
-    // I2S出力を有効化
-    audio_i2s_set_enabled(true);
 
-    // 音声生成を開始
+#if SINE_WAVE_VERIFY
+    // 検証を開始してから出力を有効化（最初のバッファからチェック対象）
+    audio_verify_config_t verify_config = {
+        .step = VERIFY_STEP,
+        .max_missing_frames = SAMPLES_PER_BUFFER,
+        .jitter_tolerance_us = 200,
+    };
+    audio_verify_start(&verify_config);
+#endif
+
+    // 音声生成を開始してからI2S出力を有効化（有効化時に最初の2バッファがレンダーされる）
     decode_flg = true;
-    return producer_pool;
+    audio_i2s_set_enabled(true);
 }
 
 /**
- * @brief メイン関数
- * 
- * システムを初期化し、インタラクティブなサイン波ジェネレーターを実行します。
- * ユーザーはキーボード入力で音量と周波数をリアルタイムに制御できます。
+ * @brief 操作方法を表示
  */
-int main() {
-
-    stdio_init_all();
-    
-    sleep_ms(2000);  // USBシリアル安定化
-    
+static void print_usage()
+{
     printf("\n=== 32bit I2S DAC サイン波ジェネレーター ===\n");
     printf("操作方法:\n");
     printf("  +/= : 音量アップ\n");
     printf("  -   : 音量ダウン\n");
     printf("  [/] : 左チャンネル周波数調整\n");
     printf("  {/} : 右チャンネル周波数調整\n");
-    printf("  q   : 終了\n\n");
+    printf("  q   : 終了\n");
+#if SINE_WAVE_VERIFY
+    printf("  v   : 連続性チェック結果を表示\n");
+    printf("*** 検証モード: ランプ信号を出力します ***\n");
+#endif
+    printf("\n");
+}
 
-    // =============================================================================
-    // システムクロック設定 (96MHz動作)
-    // =============================================================================
-    
+/**
+ * @brief システムクロック設定 (96MHz動作)
+ */
+static void setup_clocks()
+{
     // USB PLL を 96MHz に設定
     pll_init(pll_usb, 1, 1536 * MHZ, 4, 4);
     
@@ -277,9 +257,45 @@ int main() {
         CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS,
         96 * MHZ,
         96 * MHZ);
+}
+
+/**
+ * @brief サイン波テーブルの生成（高速な波形生成のため）
+ */
+static void init_sine_table()
+{
+    for (int i = 0; i < SINE_WAVE_TABLE_LEN; i++) {
+        sine_wave_table[i] = 32767 * cosf(i * 2 * (float) (M_PI / SINE_WAVE_TABLE_LEN));
+    }
+}
+
+/**
+ * @brief メイン関数
+ * 
+ * システムを初期化し、インタラクティブなサイン波ジェネレーターを実行します。
+ * ユーザーはキーボード入力で音量と周波数をリアルタイムに制御できます。
+ */
+int main() {
+
+#if SINE_WAVE_FAST_BOOT
+    // クロックとI2Sを先に立ち上げ、USB CDCの列挙は後から非同期に進める
+    setup_clocks();
+    init_sine_table();
+    i2s_audio_init(44100);
+    stdio_init_all();
+    print_usage();
+#else
+    stdio_init_all();
+    
+    sleep_ms(2000);  // USBシリアル安定化
+    
+    print_usage();
+
+    setup_clocks();
         
     // クロック変更後にUARTを再初期化
     stdio_init_all();
+#endif
 
     // =============================================================================
     // DCDC電源制御（オーディオノイズ低減）
@@ -307,19 +323,14 @@ int main() {
     g_analog_mux.Init(mux_config);
     printf("アナログマルチプレクサー初期化完了\n");
 
-    // =============================================================================
-    // サイン波テーブルの生成
-    // =============================================================================
-    
-    // プリ計算されたサイン波テーブルを生成（高速な波形生成のため）
-    for (int i = 0; i < SINE_WAVE_TABLE_LEN; i++) {
-        sine_wave_table[i] = 32767 * cosf(i * 2 * (float) (M_PI / SINE_WAVE_TABLE_LEN));
-    }
+#if !SINE_WAVE_FAST_BOOT
+    init_sine_table();
 
     printf("I2Sオーディオシステム初期化中...\n");
     
     // I2Sオーディオシステムを 44.1kHz で初期化
-    ap = i2s_audio_init(44100);
+    i2s_audio_init(44100);
+#endif
     
     printf("初期化完了。音声出力を開始しました。\n\n");
 
@@ -377,7 +388,19 @@ int main() {
             if (c == '{' && step1 > 0x10000) step1 -= 0x10000;
             if (c == '}' && step1 < (SINE_WAVE_TABLE_LEN / 16) * 0x20000) step1 += 0x10000;
             if (c == 'q') break;
+#if SINE_WAVE_VERIFY
+            if (c == 'v') audio_verify_print_report();
+#endif
+        }
+
+#if SINE_WAVE_VERIFY
+        // 検証結果を定期的に表示
+        static uint32_t last_report_time = 0;
+        if (current_time - last_report_time > VERIFY_REPORT_INTERVAL_MS) {
+            audio_verify_print_report();
+            last_report_time = current_time;
         }
+#endif
         
         
         // 短い待機
@@ -390,39 +413,59 @@ int main() {
     return 0;
 }
 
+// =============================================================================
+// I2S レンダーコールバック
+// =============================================================================
+
 /**
- * @brief オーディオサンプルの生成とバッファへの書き込み
+ * @brief DMAが次に再生するバッファへ直接サイン波を書き込む
  * 
- * サイン波テーブルを使用して左右チャンネルのオーディオデータを生成し、
- * 32bit PCMフォーマットでバッファに書き込みます。
+ * audio_i2s_set_render_callback() で登録され、DMA割り込みから呼び出されます。
+ * バッファの取得・返却やコピーは不要で、渡されたメモリに書き込むだけです。
  * 
  * 処理内容:
- * 1. 空きバッファの取得
- * 2. 各サンプルに対してサイン波値の計算
- * 3. 音量調整と32bit フルスケール変換
- * 4. 位相の更新とラップアラウンド処理
- * 5. バッファの返却
+ * 1. 各サンプルに対してサイン波値の計算
+ * 2. 音量調整と32bit フルスケール変換
+ * 3. 位相の更新とラップアラウンド処理
+ * 
+ * 注意事項:
+ * - この関数は割り込みコンテキストで実行されます
+ * - 1バッファの再生時間内に必ず終わらせること（ブロッキング操作は禁止）
+ * 
+ * @param ctx 未使用
+ * @param out 出力先（32bitステレオ、L/R インターリーブ）
+ * @param frames 書き込むフレーム数
+ * @param frame_pos ストリーム先頭からのフレーム位置（未使用）
  */
-void decode()
+static void render(void *ctx, int32_t *out, uint frames, uint64_t frame_pos)
 {
-    // 空きバッファを取得（ノンブロッキング）
-    audio_buffer_t *buffer = take_audio_buffer(ap, false);
-    if (buffer == NULL) { 
-        return;  // バッファが利用できない場合は何もしない
+    (void) ctx;
+    (void) frame_pos;
+
+    if (!decode_flg) {
+        // 停止中は無音
+        for (uint i = 0; i < frames; i++) {
+            out[i*2+0] = DAC_ZERO;
+            out[i*2+1] = DAC_ZERO;
+        }
+        return;
     }
-    
-    // バッファを32bitサンプル配列としてアクセス
-    int32_t *samples = (int32_t *) buffer->buffer->bytes;
-    
+
+#if SINE_WAVE_VERIFY
+    // 検証モード: サイン波の代わりにランプ信号を書き込む（全チャンネル同値）
+    audio_verify_generate_frames(out, AUDIO_PCM_FORMAT_S32, 2, frames, &verify_phase, VERIFY_STEP);
+    return;
+#endif
+
     // 各サンプルを生成
-    for (uint i = 0; i < buffer->max_sample_count; i++) {
+    for (uint i = 0; i < frames; i++) {
         // サイン波テーブルから値を取得し、音量を適用
         int32_t value0 = (vol * sine_wave_table[pos0 >> 16u]) << 8u;  // 左チャンネル
         int32_t value1 = (vol * sine_wave_table[pos1 >> 16u]) << 8u;  // 右チャンネル
         
         // 32bitフルスケールに変換（ディザリング効果も含む）
-        samples[i*2+0] = value0 + (value0 >> 16u);  // 左チャンネル出力
-        samples[i*2+1] = value1 + (value1 >> 16u);  // 右チャンネル出力
+        out[i*2+0] = value0 + (value0 >> 16u);  // 左チャンネル出力
+        out[i*2+1] = value1 + (value1 >> 16u);  // 右チャンネル出力
         
         // 位相を進める
         pos0 += step0;  // 左チャンネルの位相更新
@@ -432,38 +475,4 @@ void decode()
         if (pos0 >= pos_max) pos0 -= pos_max;
         if (pos1 >= pos_max) pos1 -= pos_max;
     }
-    
-    // サンプル数を設定してバッファを返却
-    buffer->sample_count = buffer->max_sample_count;
-    give_audio_buffer(ap, buffer);
-    return;
-}
-
-// =============================================================================
-// I2S DMA割り込みコールバック
-// =============================================================================
-
-extern "C" {
-/**
- * @brief I2S DMA割り込みハンドラから呼び出されるコールバック関数
- * 
- * この関数は audio_i2s.c 内の audio_i2s_dma_irq_handler() から
- * 呼び出されます。__attribute__((weak)) で宣言されているため、
- * ここで実装を提供することで独自の音声生成処理を実行できます。
- * 
- * 呼び出しタイミング:
- * - DMAバッファが空になったとき
- * - 新しいオーディオデータが必要なとき
- * 
- * 注意事項:
- * - この関数は割り込みコンテキストで実行されます
- * - 処理時間を最小限に抑える必要があります
- * - ブロッキング操作は避けてください
- */
-void i2s_callback_func()
-{
-    if (decode_flg) {
-        decode();  // 音声データ生成処理を呼び出し
-    }
 }
-}
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 pico_audio_i2s_32b contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file audio_upsample_test.c
+ * @brief Checks the audio_upsample C reference against the blend definition
+ *
+ * audio_utils_ref.c defines the arithmetic the RP2040, Cortex-M33 and Hazard3
+ * kernels implement. This test pins that definition down on the host: every
+ * output is compared with the interpolator blend computed independently in
+ * 64 bit, (s0 * (256 - alpha) + s1 * alpha) >> 8 rounded towards minus
+ * infinity, over full-scale steps, every alpha and odd output lengths.
+ * The assembler kernels themselves need the target to run.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/audio.h" // host shim generated by CMakeLists.txt
+
+#define INPUT_COUNT 4096
+#define MAX_OUTPUT 1024
+
+static int16_t input[INPUT_COUNT + 1];
+static int16_t output[MAX_OUTPUT * 2 + 2];
+static int failures;
+
+static int16_t expected(uint i, uint32_t step) {
+    uint64_t pos = (uint64_t) i * step;
+    int64_t s0 = input[pos >> 12];
+    int64_t s1 = input[(pos >> 12) + 1];
+    int64_t alpha = (int64_t) ((pos >> 4) & 0xff);
+    int64_t num = s0 * (256 - alpha) + s1 * alpha;
+    // floor division, independent of how >> treats negative numbers
+    int64_t q = num / 256;
+    if (num % 256 < 0) q--;
+    return (int16_t) q;
+}
+
+static void fail(const char *name, uint32_t step, uint count, uint i, int got, int want) {
+    if (failures++ < 20) {
+        printf("FAIL %s step 0x%04x count %u: out[%u] = %d, expected %d\n", name, (unsigned) step, count, i, got,
+               want);
+    }
+}
+
+static void check_upsample(uint32_t step, uint count) {
+    memset(output, 0x55, sizeof(output));
+    audio_upsample(input, output, count, step);
+    for (uint i = 0; i < count; i++) {
+        int16_t want = expected(i, step);
+        if (output[i] != want) fail("audio_upsample", step, count, i, output[i], want);
+    }
+    if (output[count] != 0x5555) fail("audio_upsample (overrun)", step, count, count, output[count], 0x5555);
+}
+
+static void check_upsample_words(uint32_t step, uint word_count) {
+    memset(output, 0x55, sizeof(output));
+    audio_upsample_words(input, output, word_count, step);
+    for (uint i = 0; i < word_count * 2; i++) {
+        int16_t want = expected(i, step);
+        if (output[i] != want) fail("audio_upsample_words", step, word_count, i, output[i], want);
+    }
+    if (output[word_count * 2] != 0x5555) {
+        fail("audio_upsample_words (overrun)", step, word_count, word_count * 2, output[word_count * 2], 0x5555);
+    }
+}
+
+static void check_upsample_double(uint32_t step, uint count) {
+    memset(output, 0x55, sizeof(output));
+    audio_upsample_double(input, output, count, step);
+    for (uint i = 0; i < count; i++) {
+        int16_t want = expected(i, step);
+        if (output[i * 2] != want) fail("audio_upsample_double L", step, count, i, output[i * 2], want);
+        if (output[i * 2 + 1] != want) fail("audio_upsample_double R", step, count, i, output[i * 2 + 1], want);
+    }
+    if (output[count * 2] != 0x5555) fail("audio_upsample_double (overrun)", step, count, count, output[count * 2], 0x5555);
+}
+
+static void check_literal(void) {
+    // full-scale jumps in both directions: the blend must round towards minus infinity
+    static const struct {
+        int16_t s0, s1;
+        uint32_t step;
+        int16_t out1;
+    } cases[] = {
+            {-32768, 32767, 0xff0, 32511},  // alpha 255: 32511.004
+            {32767, -32768, 0xff0, -32513}, // alpha 255: -32512.004
+            {32767, -32768, 0x010, 32511},  // alpha 1:    32511.004
+            {-32768, 32767, 0x010, -32513}, // alpha 1:   -32512.004
+            {-1, 0, 0x800, -1},             // alpha 128: -0.5
+            {1, 0, 0x800, 0},               // alpha 128:  0.5
+    };
+    for (uint c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        int16_t in[3] = {cases[c].s0, cases[c].s1, cases[c].s1};
+        int16_t out[2];
+        audio_upsample(in, out, 2, cases[c].step);
+        if (out[0] != cases[c].s0) fail("literal", cases[c].step, 2, 0, out[0], cases[c].s0);
+        if (out[1] != cases[c].out1) fail("literal", cases[c].step, 2, 1, out[1], cases[c].out1);
+    }
+}
+
+int main(void) {
+    // full-scale square wave alternating with noise, so neighbours span the whole int16 range
+    uint32_t lcg = 12345;
+    for (uint i = 0; i <= INPUT_COUNT; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        if ((i / 3) & 1) {
+            input[i] = (int16_t) (lcg >> 16);
+        } else {
+            input[i] = (i & 1) ? INT16_MAX : INT16_MIN;
+        }
+    }
+
+    static const uint32_t steps[] = {0x001, 0x010, 0x0ff, 0x800, 0x93a, 0xeb3, 0xff0, 0xfff};
+    static const uint counts[] = {1, 2, 3, 7, 63, 64, 255, 1023};
+    for (uint s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        for (uint c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+            check_upsample(steps[s], counts[c]);
+            check_upsample_words(steps[s], counts[c] / 2 + 1);
+            check_upsample_double(steps[s], counts[c]);
+        }
+    }
+    // every alpha with both neighbours at the opposite full-scale rails
+    for (uint32_t step = 0x010; step < 0x1000; step += 0x010) check_upsample(step, 2);
+    check_literal();
+
+    if (failures) {
+        printf("audio_upsample_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("audio_upsample_test: PASS\n");
+    return 0;
+}
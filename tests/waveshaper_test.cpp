@@ -0,0 +1,103 @@
+/**
+ * @file waveshaper_test.cpp
+ * @brief Cross FM Noise Synthesizer - Waveshaper と OverdriveCurve の突き合わせ（ホスト）
+ *
+ * Init() したテーブル（OverdriveCurve、17スライス × 257点）の Process() を、
+ * ドライブ 0 ～ 1 と入力 -1 ～ 1 の格子で OverdriveCurve() の直接計算と比べます。
+ *
+ * - |x| >= 1/64: 誤差 kTolerance 以内（ドライブ方向の補間誤差が最大で約0.07）
+ * - 全域: 出力の大きさが kMaxOutput 以下で、符号が入力と一致する
+ *   （高ドライブのカーブは 0 付近の傾きが入力方向の刻み（1/128）より急なので、
+ *   |x| < 1/64 では直線補間の値になり、比較しない）
+ * - Q31 版は、±1 で飽和させた同じカーブの float 版と一致する
+ *   （Q31 のテーブルは中ドライブでの SoftClip のオーバーシュートを表せない）
+ * - ProcessBlock() はドライブ一定なら Process() と一致する
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "../products/cross_fm_noise_synth/include/waveshaper.h"
+
+namespace
+{
+constexpr float kTolerance   = 0.075f;
+constexpr float kMaxOutput   = 1.06f; // 中ドライブでの SoftClip のオーバーシュート
+constexpr float kQ31Tolerance = 1.0e-4f;
+constexpr int   kInputSteps  = 2000;  // 入力 -1 ～ 1 を 4000 区間
+
+int failures = 0;
+
+void Fail(const char *what, float drive, float x, float got, float want)
+{
+    if (failures++ < 20) {
+        printf("FAIL %s drive %.3f x %.5f: %.5f, expected %.5f\n", what, drive, x, got, want);
+    }
+}
+
+Waveshaper<float>   shaper;
+Waveshaper<float>   shaper_clipped; // Q31 の比較対象
+Waveshaper<int32_t> shaper_q31;
+
+float ClippedOverdriveCurve(float drive, float x)
+{
+    const float y = OverdriveCurve(drive, x);
+    return y > 1.0f ? 1.0f : (y < -1.0f ? -1.0f : y);
+}
+
+void CheckDrive(float drive)
+{
+    shaper.SetDrive(drive);
+    shaper_clipped.SetDrive(drive);
+    shaper_q31.SetDrive(drive);
+    for (int i = -kInputSteps; i <= kInputSteps; i++) {
+        const float x    = (float)i / (float)kInputSteps;
+        const float y    = shaper.Process(x);
+        const float want = OverdriveCurve(drive, x);
+
+        if (fabsf(x) >= 1.0f / 64.0f && fabsf(y - want) > kTolerance) Fail("curve", drive, x, y, want);
+        if (fabsf(y) > kMaxOutput) Fail("range", drive, x, y, want);
+        if ((x > 0.0f && y < 0.0f) || (x < 0.0f && y > 0.0f)) Fail("sign", drive, x, y, want);
+
+        const int32_t in_q31    = x >= 1.0f ? INT32_MAX : (int32_t)(x * 2147483648.0);
+        const float   y_q31     = (float)shaper_q31.Process(in_q31) / 2147483648.0f;
+        const float   y_clipped = shaper_clipped.Process(x);
+        if (fabsf(y_q31 - y_clipped) > kQ31Tolerance) Fail("q31", drive, x, y_q31, y_clipped);
+    }
+}
+
+void CheckBlock(float drive)
+{
+    // 直前と同じドライブなら、ブロック内で補間してもサンプル単位と同じ値
+    float block[64];
+    for (int i = 0; i < 64; i++) block[i] = (float)(i - 32) / 32.0f;
+    shaper.SetDrive(drive);
+    shaper.ProcessBlock(block, 64);
+    shaper.ProcessBlock(block, 0);
+    for (int i = 0; i < 64; i++) block[i] = (float)(i - 32) / 32.0f;
+    shaper.ProcessBlock(block, 64);
+    for (int i = 0; i < 64; i++) {
+        const float x    = (float)(i - 32) / 32.0f;
+        const float want = shaper.Process(x);
+        if (block[i] != want) Fail("block", drive, x, block[i], want);
+    }
+}
+} // namespace
+
+int main()
+{
+    shaper.Init();
+    shaper_clipped.LoadCurve(ClippedOverdriveCurve, Waveshaper<float>::kMaxSlices);
+    shaper_q31.Init();
+
+    for (int d = 0; d <= 100; d++) CheckDrive((float)d / 100.0f);
+    CheckDrive(kOverdriveMaxDrive);
+    for (int d = 0; d <= 8; d++) CheckBlock((float)d / 8.0f);
+
+    if (failures) {
+        printf("waveshaper_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("waveshaper_test: PASS\n");
+    return 0;
+}
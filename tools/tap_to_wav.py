@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""Capture an audio tap stream into a WAV file.
+
+Usage:
+    python3 tools/tap_to_wav.py --tap 0 --seconds 10 -o i2s_out.wav
+    python3 tools/tap_to_wav.py --tap 16 --seconds 5 -o node.wav --raw capture.bin
+    python3 tools/tap_to_wav.py --input capture.bin --tap 16 -o node.wav
+
+The firmware must be built with PICO_AUDIO_TAP=1 and call audio_tap_usb_init()
+(pico_audio_tap_usb). The tap is selected with a vendor control request and the
+block stream is read from the bulk IN endpoint; --input converts a stream saved
+earlier with --raw instead. The samples are written exactly as the firmware
+produced them (F32 taps become 32-bit float WAV files).
+
+Selecting a tap empties the device ring and starts a new generation, which is
+stamped into every block header; only blocks of the selected tap and generation
+are recorded, so data left over from an earlier capture is skipped. A --raw
+file is converted using the generation of its last block for the tap (or
+--generation).
+
+Blocks dropped on the device (ring full) show up as gaps in the block sequence,
+which starts at 0 in each generation; they are filled with silence so the timing stays right, unless --no-fill.
+"""
+
+import argparse
+import struct
+import sys
+
+# Keep in sync with pico/audio_tap.h
+AUDIO_TAP_MAGIC = 0x5441
+AUDIO_TAP_NONE = 0xFF
+AUDIO_TAP_USB_REQUEST_SELECT = 0x01
+AUDIO_TAP_USB_REQUEST_GET_GENERATION = 0x02
+AUDIO_TAP_USB_VID = 0x2E8A
+AUDIO_TAP_USB_PID = 0xFEDC
+EP_IN = 0x81
+HEADER = struct.Struct("<HBBBBHII")  # audio_tap_block_header_t
+
+# Keep in sync with audio_pcm_format_t in pico/audio.h: (name, bytes per sample)
+PCM_FORMATS = {
+    0: ("S32", 4),
+    1: ("S16", 2),
+    2: ("S8", 1),
+    3: ("U32", 4),
+    4: ("U16", 2),
+    5: ("U8", 1),
+    6: ("F32", 4),
+}
+
+
+def parse_blocks(chunks):
+    """Yield (header tuple, sample bytes) from an iterable of stream chunks."""
+    data = bytearray()
+    for chunk in chunks:
+        data += chunk
+        pos = 0
+        while len(data) - pos >= HEADER.size:
+            header = HEADER.unpack_from(data, pos)
+            magic, tap, pcm_format, channels, _, frames, _, _ = header
+            if magic != AUDIO_TAP_MAGIC or pcm_format not in PCM_FORMATS or not channels:
+                # not on a block boundary (capture started mid-block); resync byte by byte
+                pos += 1
+                continue
+            size = frames * channels * PCM_FORMATS[pcm_format][1]
+            if len(data) - pos - HEADER.size < size:
+                break
+            start = pos + HEADER.size
+            yield header, bytes(data[start:start + size])
+            pos = start + size
+        del data[:pos]
+
+
+def silence(pcm_format, size):
+    """size bytes of silence in the device format (unsigned formats centre on the half scale code)."""
+    name, width = PCM_FORMATS[pcm_format]
+    if not name.startswith("U"):
+        return bytes(size)
+    sample = (1 << (width * 8 - 1)).to_bytes(width, "little")
+    return sample * (size // width)
+
+
+def to_wav_samples(pcm_format, samples):
+    """Return (wav format tag, bits, bytes) with unsigned/signed fixed up for WAV."""
+    name, width = PCM_FORMATS[pcm_format]
+    if name == "F32":
+        return 3, 32, samples
+    if name in ("S16", "S32", "U8"):
+        return 1, width * 8, samples
+    # WAV is signed above 8 bits and unsigned at 8 bits: flip the sign bit
+    out = bytearray(samples)
+    for i in range(width - 1, len(out), width):
+        out[i] ^= 0x80
+    return 1, width * 8, bytes(out)
+
+
+def write_wav(path, format_tag, bits, channels, sample_freq, data):
+    block_align = channels * bits // 8
+    fmt = struct.pack("<HHIIHH", format_tag, channels, sample_freq, sample_freq * block_align, block_align, bits)
+    with open(path, "wb") as f:
+        f.write(b"RIFF" + struct.pack("<I", 4 + 8 + len(fmt) + 8 + len(data)) + b"WAVE")
+        f.write(b"fmt " + struct.pack("<I", len(fmt)) + fmt)
+        f.write(b"data" + struct.pack("<I", len(data)) + data)
+
+
+def usb_select(tap, seconds_hint):
+    """Open the device, select the tap and return (device, generation of the selection)."""
+    import usb.core  # pyusb, only needed for live capture
+
+    dev = usb.core.find(idVendor=AUDIO_TAP_USB_VID, idProduct=AUDIO_TAP_USB_PID)
+    if dev is None:
+        raise SystemExit("tap device %04x:%04x not found" % (AUDIO_TAP_USB_VID, AUDIO_TAP_USB_PID))
+    dev.set_configuration()
+    # host to device / device to host, vendor, interface 0
+    dev.ctrl_transfer(0x41, AUDIO_TAP_USB_REQUEST_SELECT, tap, 0, None)
+    generation = dev.ctrl_transfer(0xC1, AUDIO_TAP_USB_REQUEST_GET_GENERATION, 0, 0, 1)[0]
+    print("recording tap %d for %.1f s" % (tap, seconds_hint), file=sys.stderr)
+    return dev, generation
+
+
+def usb_chunks(dev, timeout_ms, raw):
+    try:
+        while True:
+            chunk = bytes(dev.read(EP_IN, 16384, timeout=timeout_ms))
+            if raw:
+                raw.write(chunk)
+            yield chunk
+    finally:
+        dev.ctrl_transfer(0x41, AUDIO_TAP_USB_REQUEST_SELECT, AUDIO_TAP_NONE, 0, None)
+
+
+def last_generation(path, tap):
+    """Generation of the last block of tap in a raw file (the capture; stale blocks come first)."""
+    generation = None
+    for header, _ in parse_blocks(file_chunks(path)):
+        if header[1] == tap:
+            generation = header[4]
+    return generation
+
+
+def file_chunks(path):
+    with open(path, "rb") as f:
+        while True:
+            chunk = f.read(65536)
+            if not chunk:
+                return
+            yield chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", required=True, help="output WAV file")
+    parser.add_argument("--tap", type=int, default=0, help="tap id (0 = I2S output, 16+ = application taps)")
+    parser.add_argument("--seconds", type=float, default=10.0, help="length to record")
+    parser.add_argument("--input", help="convert a raw stream saved with --raw instead of capturing")
+    parser.add_argument("--raw", help="also save the raw stream to this file")
+    parser.add_argument("--timeout", type=float, default=2.0, help="USB read timeout in seconds")
+    parser.add_argument("--no-fill", action="store_true", help="do not fill dropped blocks with silence")
+    parser.add_argument("--generation", type=int, help="with --input: generation to convert (default: the last)")
+    args = parser.parse_args()
+
+    raw = None
+    if args.input:
+        generation = args.generation if args.generation is not None else last_generation(args.input, args.tap)
+        chunks = file_chunks(args.input)
+    else:
+        dev, generation = usb_select(args.tap, args.seconds)
+        raw = open(args.raw, "wb") if args.raw else None
+        chunks = usb_chunks(dev, int(args.timeout * 1000), raw)
+    fmt = None
+    data = bytearray()
+    frames = 0
+    expected_sequence = 0  # every generation starts at sequence 0
+    dropped = 0
+    try:
+        for header, samples in parse_blocks(chunks):
+            _, tap, pcm_format, channels, block_generation, block_frames, sample_freq, sequence = header
+            # blocks of an earlier selection (still in flight when the tap was selected)
+            if tap != args.tap or block_generation != generation:
+                continue
+            if fmt is None:
+                fmt = (pcm_format, channels, sample_freq)
+                print("format %s x %d ch @ %d Hz" % (PCM_FORMATS[pcm_format][0], channels, sample_freq),
+                      file=sys.stderr)
+            elif fmt != (pcm_format, channels, sample_freq):
+                print("format changed mid-stream; stopping here", file=sys.stderr)
+                break
+            if sequence != expected_sequence:
+                missing = (sequence - expected_sequence) & 0xFFFFFFFF
+                dropped += missing
+                if not args.no_fill:
+                    data += silence(pcm_format, len(samples) * missing)
+                    frames += block_frames * missing
+            expected_sequence = (sequence + 1) & 0xFFFFFFFF
+            data += samples
+            frames += block_frames
+            if frames >= args.seconds * sample_freq:
+                break
+    finally:
+        if raw:
+            raw.close()
+
+    if fmt is None:
+        raise SystemExit("no blocks for tap %d in the stream" % args.tap)
+    pcm_format, channels, sample_freq = fmt
+    format_tag, bits, wav_data = to_wav_samples(pcm_format, bytes(data))
+    write_wav(args.output, format_tag, bits, channels, sample_freq, wav_data)
+    print("%d frames (%.2f s), %d blocks dropped" % (frames, frames / sample_freq, dropped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Convert an audio_trace_dump() capture into Chrome trace JSON.
+
+Usage:
+    python3 tools/trace_to_chrome.py capture.log -o trace.json
+    python3 tools/trace_to_chrome.py --port /dev/ttyACM0 -o trace.json
+
+The input is the serial log of a firmware built with PICO_AUDIO_TRACE=1 after
+sending 't'. Only the block between "# audio_trace begin" and
+"# audio_trace end" is used, so the rest of the log can stay in the file.
+Open the result in chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import argparse
+import json
+import sys
+
+# Keep in sync with audio_trace_event_t in pico/audio_trace.h
+DMA_IRQ_ENTER = 0
+DMA_IRQ_EXIT = 1
+BUFFER_TAKE = 2
+BUFFER_GIVE = 3
+RENDER_START = 4
+RENDER_STOP = 5
+UNDERRUN = 6
+
+POOL_TYPES = {0: "producer", 1: "consumer"}
+
+# begin/end pairs shown as duration slices
+SLICES = {
+    DMA_IRQ_ENTER: ("B", "dma_irq"),
+    DMA_IRQ_EXIT: ("E", "dma_irq"),
+    RENDER_START: ("B", "render"),
+    RENDER_STOP: ("E", "render"),
+}
+
+
+def read_dump(lines):
+    """Yield (core, timestamp_us, event, arg, name) from the dump block."""
+    inside = False
+    for line in lines:
+        line = line.strip()
+        if line == "# audio_trace begin":
+            inside = True
+            continue
+        if line == "# audio_trace end":
+            break
+        if not inside or not line or line.startswith("core,"):
+            continue
+        core, timestamp, event, arg, name = line.split(",", 4)
+        yield int(core), int(timestamp), int(event), int(arg), name
+
+
+def unwrap(records):
+    """time_us_32() wraps every ~71 minutes; make timestamps monotonic per core.
+
+    Consecutive records of a core are far less than 2^31 us apart, so the
+    difference is taken modulo 2^32 as a signed value: only a large backwards
+    jump counts as a wrap, and a slightly older record stays slightly older.
+    """
+    last = {}
+    for core, timestamp, event, arg, name in records:
+        if core in last:
+            raw, unwrapped = last[core]
+            delta = (timestamp - raw) & 0xFFFFFFFF
+            if delta >= 1 << 31:
+                delta -= 1 << 32
+            unwrapped += delta
+        else:
+            unwrapped = timestamp
+        last[core] = (timestamp, unwrapped)
+        yield core, unwrapped, event, arg, name
+
+
+def to_chrome(records):
+    events = []
+    for core in sorted({r[0] for r in records}):
+        events.append({"ph": "M", "name": "thread_name", "pid": 0, "tid": core,
+                       "args": {"name": "core%d" % core}})
+    for core, timestamp, event, arg, name in records:
+        base = {"pid": 0, "tid": core, "ts": timestamp}
+        if event in SLICES:
+            ph, slice_name = SLICES[event]
+            events.append(dict(base, ph=ph, name=slice_name, args={"arg": arg}))
+        elif event in (BUFFER_TAKE, BUFFER_GIVE):
+            events.append(dict(base, ph="i", s="t", name=name,
+                               args={"pool": POOL_TYPES.get(arg, arg)}))
+        elif event == UNDERRUN:
+            events.append(dict(base, ph="i", s="g", name=name, args={"dma_channel": arg}))
+        else:
+            events.append(dict(base, ph="i", s="t", name="%s_%d" % (name, event), args={"arg": arg}))
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def capture_from_port(port, baud, timeout):
+    import serial  # pyserial, only needed for live capture
+
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"t")
+        lines = []
+        while True:
+            raw = ser.readline()
+            if not raw:
+                raise SystemExit("timeout waiting for trace dump")
+            line = raw.decode("utf-8", errors="replace")
+            lines.append(line)
+            if line.strip() == "# audio_trace end":
+                return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", help="captured serial log (default: stdin)")
+    parser.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    parser.add_argument("--port", help="serial port to request a dump from directly")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=5.0)
+    args = parser.parse_args()
+
+    if args.port:
+        lines = capture_from_port(args.port, args.baud, args.timeout)
+    elif args.input:
+        with open(args.input, encoding="utf-8", errors="replace") as f:
+            lines = f.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    records = sorted(unwrap(read_dump(lines)), key=lambda r: (r[1], r[0]))
+    if not records:
+        raise SystemExit("no audio_trace block found in input")
+
+    trace = to_chrome(records)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+    print("%d events" % len(records), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()